@@ -0,0 +1,103 @@
+/*
+   Copyright (C) 2015 Preet Desai (preet.desai@gmail.com)
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+// stl
+#include <atomic>
+#include <map>
+#include <mutex>
+
+// ks
+#include <ks/KsMiscUtils.hpp>
+#include <ks/gl/KsGLAttributeBindings.hpp>
+
+namespace ks
+{
+    namespace gl
+    {
+        namespace AttributeBindings
+        {
+            namespace {
+                std::mutex g_mutex;
+
+                // ordered so GetKey doesn't depend on the
+                // order bindings were added in
+                std::map<std::string,GLuint> g_lkup_locations;
+                // written with g_mutex held, read without it
+                std::atomic<u32> g_revision{0};
+
+                std::string g_log_prefix{"gl: AttributeBindings: "};
+            }
+
+            void Set(std::string name,GLuint location)
+            {
+                std::lock_guard<std::mutex> lock(g_mutex);
+                g_lkup_locations[std::move(name)] = location;
+                g_revision++;
+            }
+
+            bool Get(std::string const &name,GLuint &location)
+            {
+                std::lock_guard<std::mutex> lock(g_mutex);
+                auto it = g_lkup_locations.find(name);
+                if(it == g_lkup_locations.end()) {
+                    return false;
+                }
+                location = it->second;
+                return true;
+            }
+
+            void Clear()
+            {
+                std::lock_guard<std::mutex> lock(g_mutex);
+                g_lkup_locations.clear();
+                g_revision++;
+            }
+
+            u32 GetRevision()
+            {
+                return g_revision.load();
+            }
+
+            std::string GetKey()
+            {
+                std::lock_guard<std::mutex> lock(g_mutex);
+
+                std::string key;
+                for(auto const &name_loc : g_lkup_locations) {
+                    key += name_loc.first+"="+
+                            ConvNumberToString(name_loc.second)+";";
+                }
+                return key;
+            }
+
+            u32 GLApply(GLuint prog)
+            {
+                std::lock_guard<std::mutex> lock(g_mutex);
+
+                // Binding a name that isn't used by
+                // the program is allowed
+                for(auto const &name_loc : g_lkup_locations) {
+                    glBindAttribLocation(prog,
+                                         name_loc.second,
+                                         name_loc.first.c_str());
+                }
+                KS_CHECK_GL_ERROR(g_log_prefix+"bind attrib locations");
+
+                return g_revision.load();
+            }
+        }
+    }
+}
@@ -0,0 +1,60 @@
+/*
+   Copyright (C) 2015 Preet Desai (preet.desai@gmail.com)
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#ifndef KS_GL_ATTRIBUTE_BINDINGS_HPP
+#define KS_GL_ATTRIBUTE_BINDINGS_HPP
+
+// stl
+#include <string>
+
+// ks
+#include <ks/gl/KsGLDebug.hpp>
+
+namespace ks
+{
+    namespace gl
+    {
+        // Registry of vertex attribute name to location bindings
+        // * Every ShaderProgram linked after a binding is set gets
+        //   the attribute with that name at the same location (via
+        //   glBindAttribLocation), so vertex attribute pointers can
+        //   be kept across shader switches
+        // * Bindings should be set up once, before any programs
+        //   are linked; programs that were already linked keep
+        //   the locations they were linked with
+        namespace AttributeBindings
+        {
+            void Set(std::string name,GLuint location);
+            bool Get(std::string const &name,GLuint &location);
+            void Clear();
+
+            // * Incremented whenever the bindings change
+            // * Doesn't lock, so it's cheap enough to check per draw
+            u32 GetRevision();
+
+            // * Returns a string that uniquely identifies
+            //   the current set of bindings
+            std::string GetKey();
+
+            // * Binds all registered attribute locations for @prog;
+            //   must be called before @prog is linked
+            // * Returns the revision of the bindings that were applied
+            u32 GLApply(GLuint prog);
+        }
+    }
+}
+
+#endif // KS_GL_ATTRIBUTE_BINDINGS_HPP
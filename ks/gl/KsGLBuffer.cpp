@@ -1,4 +1,5 @@
 #include <ks/gl/KsGLBuffer.hpp>
+#include <ks/gl/KsGLStats.hpp>
 #include <algorithm>
 
 namespace ks
@@ -151,6 +152,31 @@ namespace ks
             }
         }
 
+        bool Buffer::GLBind(StateSet* state_set)
+        {
+            if(m_buffer_handle == 0) {
+                LOG.Error() << m_log_prefix
+                            << "tried to bind buffer 0";
+                return false;
+            }
+
+            state_set->SetBuffer(static_cast<GLenum>(m_target),m_buffer_handle);
+            return true;
+        }
+
+        void Buffer::GLUnbind(StateSet* state_set)
+        {
+            state_set->SetBuffer(static_cast<GLenum>(m_target),0);
+        }
+
+        void Buffer::GLCleanUp(StateSet* state_set)
+        {
+            if(m_buffer_handle != 0) {
+                state_set->SetBufferDeleted(m_buffer_handle);
+            }
+            this->GLCleanUp();
+        }
+
         void Buffer::GLSync()
         {
             for(auto& upd_uptr : m_list_updates)
@@ -167,6 +193,7 @@ namespace ks
 
 
                     KS_CHECK_GL_ERROR(m_log_prefix+"upload buffer");
+                    KS_GL_STATS_ISSUED(BufferUpload);
                     m_lk_buffer_size = update.src_sz_bytes;
                 }
                 else
@@ -177,6 +204,7 @@ namespace ks
                                     update.GetData());
 
                     KS_CHECK_GL_ERROR(m_log_prefix+"upload buffer subdata");
+                    KS_GL_STATS_ISSUED(BufferUpload);
                 }
             }
 
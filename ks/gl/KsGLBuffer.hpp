@@ -134,6 +134,14 @@ namespace ks
             virtual void GLUnbind();
             void GLCleanUp();
 
+            // * Bind, unbind and clean up through @state_set
+            //   so that redundant glBindBuffer calls are skipped
+            // * Mixing these with the calls above requires
+            //   invalidating the StateSet
+            bool GLBind(StateSet* state_set);
+            void GLUnbind(StateSet* state_set);
+            void GLCleanUp(StateSet* state_set);
+
             // * Must be called from a thread that has a valid GL
             //   context and must be synchronous with respect to
             //   any threads calling Update
@@ -24,6 +24,7 @@
 // ks
 #include <ks/gl/KsGLVertexBuffer.hpp>
 #include <ks/gl/KsGLIndexBuffer.hpp>
+#include <ks/gl/KsGLStats.hpp>
 
 namespace ks
 {
@@ -41,6 +42,7 @@ namespace ks
                          vx_array_size_bytes/vx_size_bytes);
 
             KS_CHECK_GL_ERROR("DrawArrays");
+            KS_GL_STATS_ISSUED(Draw);
         }
 
         // ============================================================= //
@@ -57,17 +59,22 @@ namespace ks
                            reinterpret_cast<void*>(offset_bytes));
 
             KS_CHECK_GL_ERROR("DrawElements");
+            KS_GL_STATS_ISSUED(Draw);
         }
 
         // ============================================================= //
 
+        // * The buffers are bound through @state_set and left
+        //   bound after the draw call; consecutive draws from
+        //   the same buffers don't rebind them
         inline void DrawArrays(Primitive primitive,
+                               StateSet* state_set,
                                ShaderProgram* shader,
                                VertexBuffer* vertex_buffer,
                                uint vx_range_start_byte,
                                uint vx_range_size_bytes)
         {
-            bool const ok = vertex_buffer->GLBindVxBuff(shader);
+            bool const ok = vertex_buffer->GLBindVxBuff(state_set,shader);
             assert(ok);
 
             // bytes per vertex
@@ -78,12 +85,13 @@ namespace ks
                          vx_range_size_bytes/vx_size);
 
             KS_CHECK_GL_ERROR(vertex_buffer->GetDesc()+"DrawArrays");
-            vertex_buffer->GLUnbind();
+            KS_GL_STATS_ISSUED(Draw);
         }
 
         // ============================================================= //
 
         inline void DrawElements(Primitive primitive,
+                                 StateSet* state_set,
                                  ShaderProgram* shader,
                                  VertexBuffer* vertex_buffer,
                                  IndexBuffer* index_buffer,
@@ -91,28 +99,32 @@ namespace ks
                                  uint ix_range_size)
         {
             bool const ok =
-                vertex_buffer->GLBindVxBuff(shader) &&
-                index_buffer->GLBind();
+                vertex_buffer->GLBindVxBuff(state_set,shader) &&
+                index_buffer->GLBind(state_set);
 
             assert(ok);
 
             // bytes per index
             uint const ix_size = 2; // 2 bytes per index
 
+            std::uintptr_t offset_bytes = ix_range_start;
+
             glDrawElements(static_cast<GLenum>(primitive),
                            ix_range_size/ix_size,
                            GL_UNSIGNED_SHORT,
-                           reinterpret_cast<void*>(ix_range_start)); // byte offset into index buffer
+                           reinterpret_cast<void*>(offset_bytes)); // byte offset into index buffer
 
             KS_CHECK_GL_ERROR(vertex_buffer->GetDesc()+"DrawElements");
-
-            vertex_buffer->GLUnbind();
-            index_buffer->GLUnbind();
+            KS_GL_STATS_ISSUED(Draw);
         }
 
         // ============================================================= //
         // ============================================================= //
 
+        // * Scissor and Viewport always call GL; prefer the
+        //   StateSet equivalents which skip redundant calls.
+        //   Mixing the two requires invalidating the StateSet
+
         inline void Scissor(sint x, sint y, sint width, sint height)
         {
             glScissor(x,y,width,height);
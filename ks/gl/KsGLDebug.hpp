@@ -19,6 +19,7 @@
 
 // sys
 #include <cassert>
+#include <string>
 
 // ks
 #include <ks/KsLog.hpp>
@@ -31,13 +32,40 @@ namespace ks
         void CheckGLError();
         void CheckGLError(std::string const &note);
         std::string GetGLErrorDesc(GLenum const gl_error);
+
+        // * Same as CheckGLError(note) but the note is only
+        //   assembled from @note_parts if there was an error,
+        //   which avoids building strings in hot paths
+        template<typename... NoteParts>
+        void CheckGLError(std::string const &note_first,
+                          char const * note_second,
+                          NoteParts const &... note_parts)
+        {
+            GLenum const gl_error = glGetError();
+            if(gl_error == GL_NO_ERROR) {
+                return;
+            }
+
+            std::string note = note_first;
+            note.append(note_second);
+
+            using expand = int[];
+            (void)expand{0,(note.append(note_parts),0)...};
+
+            LOG.Error() << "GL Error: " << note;
+            LOG.Error() << "GL Error: " << GetGLErrorDesc(gl_error);
+
+            // log any remaining errors
+            CheckGLError(note);
+            assert(gl_error == GL_NO_ERROR);
+        }
     }   // gl
 } // ks
 
 #ifdef KS_DEBUG_GL
-#define KS_CHECK_GL_ERROR(x) ks::gl::CheckGLError(x)
+#define KS_CHECK_GL_ERROR(...) ks::gl::CheckGLError(__VA_ARGS__)
 #else
-#define KS_CHECK_GL_ERROR(x)
+#define KS_CHECK_GL_ERROR(...)
 #endif
 
 
@@ -0,0 +1,213 @@
+/*
+   Copyright (C) 2015 Preet Desai (preet.desai@gmail.com)
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+// stl
+#include <vector>
+
+// ks
+#include <ks/gl/KsGLFrameBuffer.hpp>
+#include <ks/gl/KsGLStateSet.hpp>
+#include <ks/gl/KsGLStats.hpp>
+
+// GL ES 2 only
+#ifndef GL_FRAMEBUFFER_INCOMPLETE_DIMENSIONS
+#define GL_FRAMEBUFFER_INCOMPLETE_DIMENSIONS 0x8CD9
+#endif
+
+namespace ks
+{
+    namespace gl
+    {
+        namespace
+        {
+            std::string getStatusDesc(GLenum status)
+            {
+                switch(status) {
+                case GL_FRAMEBUFFER_INCOMPLETE_ATTACHMENT:
+                    return "incomplete attachment";
+                case GL_FRAMEBUFFER_INCOMPLETE_MISSING_ATTACHMENT:
+                    return "missing attachment";
+                case GL_FRAMEBUFFER_INCOMPLETE_DIMENSIONS:
+                    return "attachments have different sizes";
+                case GL_FRAMEBUFFER_UNSUPPORTED:
+                    return "unsupported combination of formats";
+                default:
+                    return "unknown status "+std::to_string(status);
+                }
+            }
+        }
+
+        // ============================================================= //
+
+        FrameBuffer::FrameBuffer() :
+            m_framebuffer_handle(0),
+            m_log_prefix("FrameBuffer: ")
+        {
+            // empty
+        }
+
+        FrameBuffer::~FrameBuffer()
+        {
+            // empty
+        }
+
+        GLuint FrameBuffer::GetHandle() const
+        {
+            return m_framebuffer_handle;
+        }
+
+        bool FrameBuffer::GLInit()
+        {
+            if(!(m_framebuffer_handle == 0)) {
+                LOG.Error() << m_log_prefix
+                            << "already have valid handle: "
+                            << m_framebuffer_handle;
+                return false;
+            }
+
+            glGenFramebuffers(1,&m_framebuffer_handle);
+            KS_CHECK_GL_ERROR(m_log_prefix+"gen framebuffers");
+
+            if(m_framebuffer_handle == 0) {
+                LOG.Error() << m_log_prefix
+                            << "failed to gen framebuffer";
+                return false;
+            }
+
+            return true;
+        }
+
+        void FrameBuffer::GLCleanUp()
+        {
+            if(!(m_framebuffer_handle == 0)) {
+                glDeleteFramebuffers(1,&m_framebuffer_handle);
+                m_framebuffer_handle = 0;
+            }
+        }
+
+        bool FrameBuffer::GLBind(StateSet* state_set)
+        {
+            if(m_framebuffer_handle == 0) {
+                LOG.Error() << m_log_prefix
+                            << "tried to bind framebuffer 0";
+                return false;
+            }
+
+            state_set->SetFrameBuffer(m_framebuffer_handle);
+            return true;
+        }
+
+        void FrameBuffer::GLUnbind(StateSet* state_set)
+        {
+            state_set->SetFrameBuffer(0);
+        }
+
+        void FrameBuffer::GLCleanUp(StateSet* state_set)
+        {
+            if(!(m_framebuffer_handle == 0)) {
+                state_set->SetFrameBufferDeleted(m_framebuffer_handle);
+            }
+            this->GLCleanUp();
+        }
+
+        bool FrameBuffer::GLAttach(StateSet* state_set,
+                                   Attachment attachment,
+                                   Texture2D* texture)
+        {
+            GLuint const handle = texture ? texture->GetHandle() : 0;
+            if(texture && handle == 0) {
+                LOG.Error() << m_log_prefix
+                            << "tried to attach uninitialized texture";
+                return false;
+            }
+
+            return glAttach(state_set,attachment,GL_TEXTURE_2D,handle);
+        }
+
+        bool FrameBuffer::GLAttach(StateSet* state_set,
+                                   Attachment attachment,
+                                   RenderBuffer* renderbuffer)
+        {
+            GLuint const handle = renderbuffer ? renderbuffer->GetHandle() : 0;
+            if(renderbuffer && handle == 0) {
+                LOG.Error() << m_log_prefix
+                            << "tried to attach uninitialized renderbuffer";
+                return false;
+            }
+
+            return glAttach(state_set,attachment,GL_RENDERBUFFER,handle);
+        }
+
+        bool FrameBuffer::GLCheckComplete(StateSet* state_set)
+        {
+            if(!GLBind(state_set)) {
+                return false;
+            }
+
+            GLenum const status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
+            KS_CHECK_GL_ERROR(m_log_prefix+"check framebuffer status");
+
+            if(status != GL_FRAMEBUFFER_COMPLETE) {
+                LOG.Error() << m_log_prefix << "incomplete: "
+                            << getStatusDesc(status);
+                return false;
+            }
+
+            return true;
+        }
+
+        bool FrameBuffer::glAttach(StateSet* state_set,
+                                   Attachment attachment,
+                                   GLenum target,
+                                   GLuint handle)
+        {
+            if(!GLBind(state_set)) {
+                return false;
+            }
+
+            // GL ES 2 has no GL_DEPTH_STENCIL_ATTACHMENT; a
+            // packed buffer is attached to both points instead
+            std::vector<GLenum> list_points;
+            if(attachment == Attachment::Color) {
+                list_points.push_back(GL_COLOR_ATTACHMENT0);
+            }
+            if(attachment == Attachment::Depth ||
+               attachment == Attachment::DepthStencil) {
+                list_points.push_back(GL_DEPTH_ATTACHMENT);
+            }
+            if(attachment == Attachment::Stencil ||
+               attachment == Attachment::DepthStencil) {
+                list_points.push_back(GL_STENCIL_ATTACHMENT);
+            }
+
+            for(GLenum point : list_points) {
+                if(target == GL_TEXTURE_2D) {
+                    glFramebufferTexture2D(GL_FRAMEBUFFER,point,
+                                           GL_TEXTURE_2D,handle,0);
+                }
+                else {
+                    glFramebufferRenderbuffer(GL_FRAMEBUFFER,point,
+                                              GL_RENDERBUFFER,handle);
+                }
+            }
+
+            KS_CHECK_GL_ERROR(m_log_prefix+"attach");
+            KS_GL_STATS_ISSUED(FrameBuffer);
+
+            return true;
+        }
+    } // gl
+} // ks
@@ -0,0 +1,95 @@
+/*
+   Copyright (C) 2015 Preet Desai (preet.desai@gmail.com)
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#ifndef KS_GL_FRAME_BUFFER_HPP
+#define KS_GL_FRAME_BUFFER_HPP
+
+// stl
+#include <string>
+
+// ks
+#include <ks/gl/KsGLResource.hpp>
+#include <ks/gl/KsGLRenderBuffer.hpp>
+#include <ks/gl/KsGLTexture2D.hpp>
+
+namespace ks
+{
+    namespace gl
+    {
+        // FrameBuffer
+        // * A framebuffer object for rendering offscreen into
+        //   Texture2Ds and RenderBuffers
+        // * GL ES 2 only has a single color attachment
+        // * Attachments aren't owned; they must be initialized
+        //   (textures must have their size set with a ReUpload
+        //   and be synced) before being attached, and must
+        //   outlive the FrameBuffer or be detached
+        class FrameBuffer : public Resource
+        {
+        public:
+            enum class Attachment : u8 {
+                Color,
+                Depth,
+                Stencil,
+                DepthStencil // a packed DEPTH24_STENCIL8 buffer
+            };
+
+            FrameBuffer();
+            ~FrameBuffer();
+
+            GLuint GetHandle() const;
+
+            bool GLInit();
+            void GLCleanUp();
+
+            // * Binds through @state_set so redundant binds are skipped
+            bool GLBind(StateSet* state_set);
+
+            // * Binds framebuffer 0
+            void GLUnbind(StateSet* state_set);
+
+            // * Cleans up and lets @state_set know the framebuffer
+            //   was deleted, so a reused handle isn't mistaken for
+            //   one that's already bound
+            void GLCleanUp(StateSet* state_set);
+
+            // * Binds the framebuffer and attaches level 0 of
+            //   @texture, or detaches @attachment if nullptr
+            bool GLAttach(StateSet* state_set,
+                          Attachment attachment,
+                          Texture2D* texture);
+
+            bool GLAttach(StateSet* state_set,
+                          Attachment attachment,
+                          RenderBuffer* renderbuffer);
+
+            // * Binds the framebuffer and checks that it can be
+            //   rendered to; logs the reason if it can't
+            bool GLCheckComplete(StateSet* state_set);
+
+        private:
+            bool glAttach(StateSet* state_set,
+                          Attachment attachment,
+                          GLenum target,
+                          GLuint handle);
+
+            GLuint m_framebuffer_handle;
+            std::string m_log_prefix;
+        };
+    } // gl
+} // ks
+
+#endif // KS_GL_FRAME_BUFFER_HPP
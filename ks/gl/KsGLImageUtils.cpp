@@ -0,0 +1,481 @@
+/*
+   Copyright (C) 2015 Preet Desai (preet.desai@gmail.com)
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+// stl
+#include <cassert>
+#include <algorithm>
+
+// ks
+#include <ks/gl/KsGLImageUtils.hpp>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define KS_GL_IMAGE_UTILS_SSE2
+#include <emmintrin.h>
+#endif
+
+namespace ks
+{
+    namespace gl
+    {
+        BufferImageData::BufferImageData(u32 buffer_width,
+                                         u32 buffer_height,
+                                         std::vector<u8> list_bytes) :
+            m_list_bytes(std::move(list_bytes))
+        {
+            width = buffer_width;
+            height = buffer_height;
+            data_ptr = m_list_bytes.data();
+        }
+
+        std::vector<u8> const & BufferImageData::GetBytes() const
+        {
+            return m_list_bytes;
+        }
+
+        // ============================================================= //
+
+        EmptyImageData::EmptyImageData(u32 image_width,u32 image_height)
+        {
+            width = image_width;
+            height = image_height;
+            data_ptr = nullptr;
+        }
+
+        // ============================================================= //
+
+        SubImageData::SubImageData(shared_ptr<ImageData const> image,
+                                   u32 image_row_bytes,
+                                   u32 bytes_per_texel,
+                                   u32 x,
+                                   u32 y,
+                                   u32 sub_width,
+                                   u32 sub_height) :
+            m_image(std::move(image)),
+            m_row_bytes(image_row_bytes)
+        {
+            assert(x+sub_width <= m_image->width);
+            assert(y+sub_height <= m_image->height);
+
+            width = sub_width;
+            height = sub_height;
+
+            // GL only reads the image through data_ptr
+            u8 const * src = static_cast<u8 const *>(m_image->data_ptr);
+            data_ptr = const_cast<u8*>(src+(y*image_row_bytes)+(x*bytes_per_texel));
+        }
+
+        u32 SubImageData::GetRowBytes() const
+        {
+            return m_row_bytes;
+        }
+
+        // ============================================================= //
+
+        namespace ImageUtils
+        {
+            namespace
+            {
+                static_assert(sizeof(RGBA8) == 4,"RGBA8 must be tightly packed");
+
+                // Bit count and position within the packed
+                // texel of each of r,g,b,a (0 bits: dropped)
+                struct PackedFormat
+                {
+                    u8 bits[4];
+                    u8 shift[4];
+                };
+
+                bool getPackedFormat(Texture2D::Format format,PackedFormat &packed)
+                {
+                    if(format == Texture2D::Format::RGB565) {
+                        packed = PackedFormat{{5,6,5,0},{11,5,0,0}};
+                    }
+                    else if(format == Texture2D::Format::RGBA4) {
+                        packed = PackedFormat{{4,4,4,4},{12,8,4,0}};
+                    }
+                    else if(format == Texture2D::Format::RGB5_A1) {
+                        packed = PackedFormat{{5,5,5,1},{11,6,1,0}};
+                    }
+                    else {
+                        return false;
+                    }
+                    return true;
+                }
+
+                u8 const g_bayer_4x4[4][4] = {
+                    { 0, 8, 2,10},
+                    {12, 4,14, 6},
+                    { 3,11, 1, 9},
+                    {15, 7,13, 5}
+                };
+
+                // Per-byte ordered dither bias for four consecutive
+                // pixels of row @y, scaled to each channel's step size
+                void calcOrderedBias(PackedFormat const &packed,uint y,u8 * bias)
+                {
+                    for(uint x=0; x < 4; x++) {
+                        for(uint c=0; c < 4; c++) {
+                            u8 const bits = packed.bits[c];
+                            bias[x*4+c] = (bits < 2 || bits > 7) ? 0 :
+                                    static_cast<u8>((g_bayer_4x4[y&3][x] << (8-bits)) >> 4);
+                        }
+                    }
+                }
+
+                u16 packPixel(RGBA8 const &px,PackedFormat const &packed,u8 const * bias)
+                {
+                    u8 const channels[4] = {px.r,px.g,px.b,px.a};
+
+                    u16 texel = 0;
+                    for(uint c=0; c < 4; c++) {
+                        if(packed.bits[c] == 0) {
+                            continue;
+                        }
+                        uint const value = std::min<uint>(channels[c]+bias[c],255);
+                        texel |= (value >> (8-packed.bits[c])) << packed.shift[c];
+                    }
+                    return texel;
+                }
+
+                // Packs a row with a (possibly zero) repeating
+                // 4 pixel bias
+                void packRow(RGBA8 const * src,
+                             uint width,
+                             PackedFormat const &packed,
+                             u8 const * bias,
+                             u16 * dst)
+                {
+                    uint x=0;
+
+                #ifdef KS_GL_IMAGE_UTILS_SSE2
+                    __m128i const bias_v = _mm_loadu_si128(reinterpret_cast<__m128i const*>(bias));
+
+                    for(; x+8 <= width; x+=8) {
+                        __m128i px0 = _mm_loadu_si128(reinterpret_cast<__m128i const*>(src+x));
+                        __m128i px1 = _mm_loadu_si128(reinterpret_cast<__m128i const*>(src+x+4));
+                        px0 = _mm_adds_epu8(px0,bias_v);
+                        px1 = _mm_adds_epu8(px1,bias_v);
+
+                        __m128i texel0 = _mm_setzero_si128();
+                        __m128i texel1 = _mm_setzero_si128();
+
+                        for(uint c=0; c < 4; c++) {
+                            u8 const bits = packed.bits[c];
+                            if(bits == 0) {
+                                continue;
+                            }
+
+                            // channel c is at bit 8*c of each 32-bit pixel
+                            __m128i const rshift = _mm_cvtsi32_si128(8*c+8-bits);
+                            __m128i const lshift = _mm_cvtsi32_si128(packed.shift[c]);
+                            __m128i const mask = _mm_set1_epi32((1 << bits)-1);
+
+                            texel0 = _mm_or_si128(texel0,_mm_sll_epi32(
+                                _mm_and_si128(_mm_srl_epi32(px0,rshift),mask),lshift));
+
+                            texel1 = _mm_or_si128(texel1,_mm_sll_epi32(
+                                _mm_and_si128(_mm_srl_epi32(px1,rshift),mask),lshift));
+                        }
+
+                        // sign extend the low 16 bits so the signed
+                        // saturating pack keeps them unchanged
+                        texel0 = _mm_srai_epi32(_mm_slli_epi32(texel0,16),16);
+                        texel1 = _mm_srai_epi32(_mm_slli_epi32(texel1,16),16);
+
+                        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst+x),
+                                         _mm_packs_epi32(texel0,texel1));
+                    }
+                #endif
+
+                    for(; x < width; x++) {
+                        dst[x] = packPixel(src[x],packed,bias+(x&3)*4);
+                    }
+                }
+
+                // Floyd-Steinberg; errors are kept in 1/16ths
+                void packImageDiffused(std::vector<RGBA8> const &list_pixels,
+                                       uint width,
+                                       uint height,
+                                       PackedFormat const &packed,
+                                       u8 * dst,
+                                       uint dst_stride)
+                {
+                    // one pixel of padding on either side
+                    std::vector<sint> list_err_curr((width+2)*4,0);
+                    std::vector<sint> list_err_next((width+2)*4,0);
+
+                    for(uint y=0; y < height; y++) {
+                        RGBA8 const * src = &(list_pixels[y*width]);
+                        u16 * dst_row = reinterpret_cast<u16*>(dst+y*dst_stride);
+
+                        for(uint x=0; x < width; x++) {
+                            u8 const channels[4] = {src[x].r,src[x].g,src[x].b,src[x].a};
+
+                            u16 texel = 0;
+                            for(uint c=0; c < 4; c++) {
+                                u8 const bits = packed.bits[c];
+                                if(bits == 0) {
+                                    continue;
+                                }
+
+                                // 1-bit alpha is thresholded
+                                if(bits == 1) {
+                                    texel |= (channels[c] >> 7) << packed.shift[c];
+                                    continue;
+                                }
+
+                                uint const e = (x+1)*4+c;
+                                sint const value = std::max<sint>(0,std::min<sint>(255,
+                                        channels[c]+(list_err_curr[e]/16)));
+
+                                sint const max_q = (1 << bits)-1;
+                                sint const q = (value*max_q + 127)/255;
+                                sint const error = value-((q*255 + max_q/2)/max_q);
+
+                                list_err_curr[e+4] += error*7;
+                                list_err_next[e-4] += error*3;
+                                list_err_next[e]   += error*5;
+                                list_err_next[e+4] += error;
+
+                                texel |= q << packed.shift[c];
+                            }
+                            dst_row[x] = texel;
+                        }
+
+                        list_err_curr.swap(list_err_next);
+                        std::fill(list_err_next.begin(),list_err_next.end(),0);
+                    }
+                }
+
+                shared_ptr<ImageData const> convertTo16Bit(
+                        std::vector<RGBA8> const &list_pixels,
+                        uint width,
+                        uint height,
+                        Texture2D::Format format,
+                        Dither dither)
+                {
+                    PackedFormat packed;
+                    if(!getPackedFormat(format,packed)) {
+                        LOG.Error() << "gl: ImageUtils: not a 16-bit format";
+                        return nullptr;
+                    }
+
+                    uint const dst_stride = width*2;
+                    std::vector<u8> list_bytes(dst_stride*height,0);
+
+                    if(dither == Dither::ErrorDiffusion) {
+                        packImageDiffused(list_pixels,width,height,
+                                          packed,list_bytes.data(),dst_stride);
+                    }
+                    else {
+                        u8 bias[16] = {0};
+                        for(uint y=0; y < height; y++) {
+                            if(dither == Dither::Ordered) {
+                                calcOrderedBias(packed,y,bias);
+                            }
+
+                            packRow(&(list_pixels[y*width]),
+                                    width,
+                                    packed,
+                                    bias,
+                                    reinterpret_cast<u16*>(&(list_bytes[y*dst_stride])));
+                        }
+                    }
+
+                    return make_shared<BufferImageData>(
+                                width,height,std::move(list_bytes));
+                }
+
+                RGBA8 average(RGBA8 const &a,RGBA8 const &b,
+                              RGBA8 const &c,RGBA8 const &d)
+                {
+                    // +2 rounds to nearest
+                    return RGBA8{
+                        static_cast<u8>((a.r+b.r+c.r+d.r+2) >> 2),
+                        static_cast<u8>((a.g+b.g+c.g+d.g+2) >> 2),
+                        static_cast<u8>((a.b+b.b+c.b+d.b+2) >> 2),
+                        static_cast<u8>((a.a+b.a+c.a+d.a+2) >> 2)
+                    };
+                }
+
+            #ifdef KS_GL_IMAGE_UTILS_SSE2
+                // Averages 4 src pixels from each of two rows down
+                // to 2 dst pixels, with 16-bit intermediate sums
+                __m128i average2x2(__m128i row0,__m128i row1)
+                {
+                    __m128i const zero = _mm_setzero_si128();
+
+                    // lanes: [p0.rgba,p1.rgba] and [p2.rgba,p3.rgba]
+                    __m128i const lo = _mm_add_epi16(_mm_unpacklo_epi8(row0,zero),
+                                                     _mm_unpacklo_epi8(row1,zero));
+
+                    __m128i const hi = _mm_add_epi16(_mm_unpackhi_epi8(row0,zero),
+                                                     _mm_unpackhi_epi8(row1,zero));
+
+                    // add horizontal neighbours (p0+p1, p2+p3)
+                    __m128i const sum_lo = _mm_add_epi16(lo,_mm_srli_si128(lo,8));
+                    __m128i const sum_hi = _mm_add_epi16(hi,_mm_srli_si128(hi,8));
+                    __m128i sum = _mm_unpacklo_epi64(sum_lo,sum_hi);
+
+                    sum = _mm_srli_epi16(_mm_add_epi16(sum,_mm_set1_epi16(2)),2);
+                    return sum;
+                }
+            #endif
+            }
+
+            // ============================================================= //
+
+            uint CalcMipmapSize(uint size)
+            {
+                return std::max<uint>(1,size/2);
+            }
+
+            uint CalcMipmapLevelCount(uint width,uint height)
+            {
+                uint count = 1;
+                while(width > 1 || height > 1) {
+                    width = CalcMipmapSize(width);
+                    height = CalcMipmapSize(height);
+                    count++;
+                }
+                return count;
+            }
+
+            void DownsampleBox(RGBA8 const * src,
+                               uint src_width,
+                               uint src_height,
+                               RGBA8 * dst)
+            {
+                uint const dst_width = CalcMipmapSize(src_width);
+                uint const dst_height = CalcMipmapSize(src_height);
+
+                for(uint y=0; y < dst_height; y++) {
+                    RGBA8 const * row0 = src + (2*y)*src_width;
+                    RGBA8 const * row1 = src + std::min(2*y+1,src_height-1)*src_width;
+                    RGBA8 * dst_row = dst + y*dst_width;
+
+                    uint x=0;
+
+                #ifdef KS_GL_IMAGE_UTILS_SSE2
+                    // 8 src pixels per row to 4 dst pixels; the
+                    // columns read are always in range since
+                    // 2*dst_width <= src_width
+                    if(src_width > 1) {
+                        for(; x+4 <= dst_width; x+=4) {
+                            u8 const * s0 = reinterpret_cast<u8 const*>(row0+2*x);
+                            u8 const * s1 = reinterpret_cast<u8 const*>(row1+2*x);
+
+                            __m128i const a = average2x2(
+                                        _mm_loadu_si128(reinterpret_cast<__m128i const*>(s0)),
+                                        _mm_loadu_si128(reinterpret_cast<__m128i const*>(s1)));
+
+                            __m128i const b = average2x2(
+                                        _mm_loadu_si128(reinterpret_cast<__m128i const*>(s0+16)),
+                                        _mm_loadu_si128(reinterpret_cast<__m128i const*>(s1+16)));
+
+                            _mm_storeu_si128(reinterpret_cast<__m128i*>(dst_row+x),
+                                             _mm_packus_epi16(a,b));
+                        }
+                    }
+                #endif
+
+                    for(; x < dst_width; x++) {
+                        uint const x0 = 2*x;
+                        uint const x1 = std::min(2*x+1,src_width-1);
+                        dst_row[x] = average(row0[x0],row0[x1],row1[x0],row1[x1]);
+                    }
+                }
+            }
+
+            std::vector<shared_ptr<ImageData const>>
+            GenMipmaps(Image<RGBA8> const &image)
+            {
+                std::vector<shared_ptr<ImageData const>> list_levels;
+
+                uint width = image.GetWidth();
+                uint height = image.GetHeight();
+                std::vector<RGBA8> const * src = &(image.GetData());
+
+                // Each level is downsampled from the previous one
+                std::vector<RGBA8> prev_level;
+
+                while(width > 1 || height > 1) {
+                    uint const next_width = CalcMipmapSize(width);
+                    uint const next_height = CalcMipmapSize(height);
+
+                    Image<RGBA8> level(next_width,next_height);
+                    auto &list_pixels = level.GetData();
+                    list_pixels.resize(next_width*next_height);
+
+                    DownsampleBox(src->data(),width,height,list_pixels.data());
+                    prev_level = list_pixels;
+                    src = &prev_level;
+
+                    list_levels.emplace_back(level.ConvertToImageDataPtr().release());
+
+                    width = next_width;
+                    height = next_height;
+                }
+
+                return list_levels;
+            }
+
+            shared_ptr<ImageData const> ConvertTo16Bit(
+                    Image<RGBA8> const &image,
+                    Texture2D::Format format,
+                    Dither dither)
+            {
+                return convertTo16Bit(image.GetData(),
+                                      image.GetWidth(),
+                                      image.GetHeight(),
+                                      format,
+                                      dither);
+            }
+
+            shared_ptr<ImageData const> ConvertTo16Bit(
+                    Image<RGB8> const &image,
+                    Texture2D::Format format,
+                    Dither dither)
+            {
+                auto const &list_rgb = image.GetData();
+
+                std::vector<RGBA8> list_rgba;
+                list_rgba.reserve(list_rgb.size());
+                for(auto const &px : list_rgb) {
+                    list_rgba.push_back(RGBA8{px.r,px.g,px.b,255});
+                }
+
+                return convertTo16Bit(list_rgba,
+                                      image.GetWidth(),
+                                      image.GetHeight(),
+                                      format,
+                                      dither);
+            }
+
+            std::future<shared_ptr<ImageData const>> ConvertTo16BitAsync(
+                    shared_ptr<Image<RGBA8> const> image,
+                    Texture2D::Format format,
+                    Dither dither)
+            {
+                return std::async(
+                            std::launch::async,
+                            [image,format,dither]() {
+                                return ConvertTo16Bit(*image,format,dither);
+                            });
+            }
+        }
+    }
+}
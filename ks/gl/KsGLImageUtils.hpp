@@ -0,0 +1,147 @@
+/*
+   Copyright (C) 2015 Preet Desai (preet.desai@gmail.com)
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#ifndef KS_GL_IMAGE_UTILS_HPP
+#define KS_GL_IMAGE_UTILS_HPP
+
+// stl
+#include <future>
+#include <vector>
+
+// ks
+#include <ks/KsGlobal.hpp>
+#include <ks/shared/KsImage.hpp>
+#include <ks/gl/KsGLTexture2D.hpp>
+
+namespace ks
+{
+    namespace gl
+    {
+        // * ImageData that owns its bytes, for data that
+        //   isn't held in an Image (ie. compressed or
+        //   packed 16-bit texels)
+        class BufferImageData : public ImageData
+        {
+        public:
+            BufferImageData(u32 buffer_width,
+                            u32 buffer_height,
+                            std::vector<u8> list_bytes);
+
+            std::vector<u8> const & GetBytes() const;
+
+        private:
+            std::vector<u8> m_list_bytes;
+        };
+
+        // * ImageData with a size but no data, for a ReUpload
+        //   that allocates a texture without specifying its
+        //   texels (ie. for render targets or streaming)
+        class EmptyImageData : public ImageData
+        {
+        public:
+            EmptyImageData(u32 image_width,u32 image_height);
+        };
+
+        // * ImageData for a rectangle of a larger image so the
+        //   rectangle can be uploaded without being copied out;
+        //   keeps @image alive
+        // * Set Texture2D::Update::src_row_bytes to GetRowBytes()
+        class SubImageData : public ImageData
+        {
+        public:
+            SubImageData(shared_ptr<ImageData const> image,
+                         u32 image_row_bytes,
+                         u32 bytes_per_texel,
+                         u32 x,
+                         u32 y,
+                         u32 sub_width,
+                         u32 sub_height);
+
+            u32 GetRowBytes() const;
+
+        private:
+            shared_ptr<ImageData const> m_image;
+            u32 m_row_bytes;
+        };
+
+        // ============================================================= //
+
+        // CPU image processing for texture uploads
+        namespace ImageUtils
+        {
+            // * Size of the next mipmap level for a dimension
+            //   of @size; halved, rounded down, at least 1
+            uint CalcMipmapSize(uint size);
+
+            // * Number of mipmap levels including level 0
+            uint CalcMipmapLevelCount(uint width,uint height);
+
+            // * Downsamples an RGBA8 image to the next mipmap
+            //   level size with a 2x2 box filter
+            // * For odd dimensions the last row or column is
+            //   clamped, so NPOT images are supported
+            // * Uses SSE2 where available
+            void DownsampleBox(RGBA8 const * src,
+                               uint src_width,
+                               uint src_height,
+                               RGBA8 * dst);
+
+            // * Generates mipmap levels 1 and up for @image,
+            //   for platforms where glGenerateMipmap is slow
+            //   or unavailable
+            // * list_levels[i] is level i+1; upload each with a
+            //   Texture2D::Update with ReUpload and mip_level set
+            std::vector<shared_ptr<ImageData const>>
+            GenMipmaps(Image<RGBA8> const &image);
+
+            enum class Dither : u8
+            {
+                None,
+                Ordered,        // 4x4 Bayer matrix
+                ErrorDiffusion  // Floyd-Steinberg
+            };
+
+            // * Converts @image to the packed 16-bit Texture2D
+            //   formats RGB565, RGBA4 or RGB5_A1, ready to be used
+            //   in a Texture2D::Update
+            // * Rows are tightly packed
+            // * The 1-bit alpha of RGB5_A1 is thresholded at 128
+            //   and never dithered
+            // * None and Ordered use SSE2 where available; error
+            //   diffusion is serial per row and isn't vectorized
+            // * Returns nullptr if @format isn't a 16-bit format
+            // * Makes no GL calls, so it can be run on any thread
+            shared_ptr<ImageData const> ConvertTo16Bit(
+                    Image<RGBA8> const &image,
+                    Texture2D::Format format,
+                    Dither dither=Dither::Ordered);
+
+            shared_ptr<ImageData const> ConvertTo16Bit(
+                    Image<RGB8> const &image,
+                    Texture2D::Format format,
+                    Dither dither=Dither::Ordered);
+
+            // * Runs ConvertTo16Bit on a separate thread; pass the
+            //   result to Texture2D::UpdateTexture once it's ready
+            std::future<shared_ptr<ImageData const>> ConvertTo16BitAsync(
+                    shared_ptr<Image<RGBA8> const> image,
+                    Texture2D::Format format,
+                    Dither dither=Dither::Ordered);
+        }
+    }
+}
+
+#endif // KS_GL_IMAGE_UTILS_HPP
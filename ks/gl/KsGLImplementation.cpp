@@ -192,6 +192,15 @@ namespace ks
                 std::lock_guard<std::mutex> lock(g_gl_mutex);
                 return g_gl_max_renderbuffer_size;
             }
+
+            bool GetUnpackRowLengthSupported()
+            {
+                #ifdef KS_ENV_GL_ES
+                    return GetGLExtensionExists("GL_EXT_unpack_subimage");
+                #else
+                    return true;
+                #endif
+            }
         }
     }
 }
@@ -42,6 +42,10 @@ namespace ks
             GLint GetMaxTextureImageUnits();
             GLint GetMaxFragmentUniformVectors();
             GLint GetMaxRenderBufferSize();
+
+            // * GL_UNPACK_ROW_LENGTH is core on desktop GL but
+            //   needs GL_EXT_unpack_subimage on GL ES 2
+            bool GetUnpackRowLengthSupported();
         }
     }
 }
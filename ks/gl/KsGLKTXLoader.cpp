@@ -0,0 +1,273 @@
+/*
+   Copyright (C) 2015 Preet Desai (preet.desai@gmail.com)
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+// stl
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <limits>
+
+// ks
+#include <ks/gl/KsGLImageUtils.hpp>
+#include <ks/gl/KsGLKTXLoader.hpp>
+
+namespace ks
+{
+    namespace gl
+    {
+        namespace KTXLoader
+        {
+            namespace
+            {
+                u8 const g_identifier[12] = {
+                    0xAB,'K','T','X',' ','1','1',0xBB,'\r','\n',0x1A,'\n'
+                };
+
+                u32 const g_endianness = 0x04030201;
+                u32 const g_endianness_swapped = 0x01020304;
+                size_t const g_header_size = 64;
+
+                std::string const g_log_prefix{"gl: KTXLoader: "};
+
+                struct Header
+                {
+                    bool swap;
+                    u32 gl_type;
+                    u32 gl_type_size;
+                    u32 gl_format;
+                    u32 gl_internal_format;
+                    u32 width;
+                    u32 height;
+                    u32 depth;
+                    u32 array_elements;
+                    u32 faces;
+                    u32 mip_levels;
+                    u32 key_value_bytes;
+                };
+
+                u32 readU32(u8 const * ptr,bool swap)
+                {
+                    u32 value;
+                    std::memcpy(&value,ptr,sizeof(u32));
+                    if(swap) {
+                        value = ((value & 0x000000FF) << 24) |
+                                ((value & 0x0000FF00) << 8) |
+                                ((value & 0x00FF0000) >> 8) |
+                                ((value & 0xFF000000) >> 24);
+                    }
+                    return value;
+                }
+
+                bool readFile(std::string const &path,
+                              std::vector<u8> &data,
+                              size_t max_bytes)
+                {
+                    std::ifstream file(path,std::ios::in | std::ios::binary);
+                    if(!file.is_open()) {
+                        LOG.Error() << g_log_prefix << "failed to open " << path;
+                        return false;
+                    }
+
+                    file.seekg(0,std::ios::end);
+                    size_t const file_size = static_cast<size_t>(file.tellg());
+                    file.seekg(0,std::ios::beg);
+
+                    data.resize(std::min(file_size,max_bytes));
+                    file.read(reinterpret_cast<char*>(data.data()),data.size());
+
+                    return !file.fail();
+                }
+
+                bool parseHeader(std::vector<u8> const &data,
+                                 Header &header,
+                                 Texture2D::Format &format)
+                {
+                    if(data.size() < g_header_size ||
+                       std::memcmp(data.data(),g_identifier,sizeof(g_identifier)) != 0) {
+                        LOG.Error() << g_log_prefix << "not a KTX file";
+                        return false;
+                    }
+
+                    u8 const * ptr = data.data()+sizeof(g_identifier);
+
+                    u32 const endianness = readU32(ptr,false);
+                    if(endianness != g_endianness &&
+                       endianness != g_endianness_swapped) {
+                        LOG.Error() << g_log_prefix << "invalid endianness";
+                        return false;
+                    }
+
+                    header.swap = (endianness == g_endianness_swapped);
+                    header.gl_type            = readU32(ptr+4,header.swap);
+                    header.gl_type_size       = readU32(ptr+8,header.swap);
+                    header.gl_format          = readU32(ptr+12,header.swap);
+                    header.gl_internal_format = readU32(ptr+16,header.swap);
+                    // skip base internal format
+                    header.width              = readU32(ptr+24,header.swap);
+                    header.height             = readU32(ptr+28,header.swap);
+                    header.depth              = readU32(ptr+32,header.swap);
+                    header.array_elements     = readU32(ptr+36,header.swap);
+                    header.faces              = readU32(ptr+40,header.swap);
+                    header.mip_levels         = readU32(ptr+44,header.swap);
+                    header.key_value_bytes    = readU32(ptr+48,header.swap);
+
+                    if(header.width == 0 || header.height == 0 ||
+                       header.depth > 1 || header.array_elements > 0 ||
+                       header.faces != 1) {
+                        LOG.Error() << g_log_prefix << "only 2D textures are supported";
+                        return false;
+                    }
+
+                    // Uncompressed data with multi-byte components
+                    // would have to be swapped as well
+                    if(header.swap && header.gl_type != 0 && header.gl_type_size > 1) {
+                        LOG.Error() << g_log_prefix << "byte swapping texel data "
+                                                       "is not supported";
+                        return false;
+                    }
+
+                    // gl_type is 0 for compressed formats
+                    GLenum const gl_format = (header.gl_type == 0) ?
+                                header.gl_internal_format : header.gl_format;
+
+                    if(!Texture2D::GetFormatFromGL(gl_format,header.gl_type,format)) {
+                        LOG.Error() << g_log_prefix << "unsupported format: "
+                                    << gl_format << ", type: " << header.gl_type;
+                        return false;
+                    }
+
+                    return true;
+                }
+            }
+
+            // ============================================================= //
+
+            bool Load(std::string const &path,Texture &texture)
+            {
+                std::vector<u8> data;
+                if(!readFile(path,data,std::numeric_limits<size_t>::max())) {
+                    return false;
+                }
+
+                return Load(data,texture);
+            }
+
+            bool Load(std::vector<u8> const &data,Texture &texture)
+            {
+                Header header;
+                if(!parseHeader(data,header,texture.format)) {
+                    return false;
+                }
+
+                texture.width = header.width;
+                texture.height = header.height;
+                texture.list_levels.clear();
+
+                // 0 levels means the loader should generate them
+                u32 const mip_levels = std::max<u32>(header.mip_levels,1);
+                size_t offset = g_header_size+header.key_value_bytes;
+
+                for(u32 i=0; i < mip_levels; i++) {
+                    if(offset+sizeof(u32) > data.size()) {
+                        LOG.Error() << g_log_prefix << "truncated file";
+                        return false;
+                    }
+
+                    u32 const size_bytes = readU32(&(data[offset]),header.swap);
+                    offset += sizeof(u32);
+
+                    u32 const level_width = std::max<u32>(header.width >> i,1);
+                    u32 const level_height = std::max<u32>(header.height >> i,1);
+
+                    // Uncompressed rows are padded to 4 bytes; see
+                    // UpdateTexture
+                    if(size_bytes < Texture2D::CalcNumBytes(texture.format,
+                                                            level_width,
+                                                            level_height) ||
+                       offset+size_bytes > data.size()) {
+                        LOG.Error() << g_log_prefix << "invalid size for level " << i;
+                        return false;
+                    }
+
+                    texture.list_levels.push_back(
+                                make_shared<BufferImageData>(
+                                    level_width,
+                                    level_height,
+                                    std::vector<u8>(data.begin()+offset,
+                                                    data.begin()+offset+size_bytes)));
+
+                    // levels are padded to 4 bytes
+                    offset += size_bytes + (3 - ((size_bytes+3) % 4));
+                }
+
+                return true;
+            }
+
+            bool GetFormat(std::string const &path,Texture2D::Format &format)
+            {
+                std::vector<u8> data;
+                if(!readFile(path,data,g_header_size)) {
+                    return false;
+                }
+
+                Header header;
+                return parseHeader(data,header,format);
+            }
+
+            sint LoadBestVariant(std::vector<std::string> const &list_paths,
+                                 Texture &texture)
+            {
+                for(uint i=0; i < list_paths.size(); i++) {
+                    Texture2D::Format format;
+                    if(!GetFormat(list_paths[i],format) ||
+                       !Texture2D::GetFormatSupported(format)) {
+                        continue;
+                    }
+
+                    if(Load(list_paths[i],texture)) {
+                        return static_cast<sint>(i);
+                    }
+                }
+
+                LOG.Error() << g_log_prefix << "no supported variant";
+                return -1;
+            }
+
+            void UpdateTexture(Texture const &texture,Texture2D* texture_2d)
+            {
+                bool const compressed = Texture2D::GetFormatCompressed(texture.format);
+                u32 const bytes_per_texel = Texture2D::CalcNumBytes(texture.format,1,1);
+
+                for(uint i=0; i < texture.list_levels.size(); i++) {
+                    Texture2D::Update update{
+                        Texture2D::Update::ReUpload,
+                        glm::u16vec2(0,0),
+                        texture.list_levels[i]
+                    };
+                    update.mip_level = i;
+
+                    // KTX pads uncompressed rows to 4 bytes
+                    if(!compressed) {
+                        update.src_row_bytes =
+                                ((texture.list_levels[i]->width*bytes_per_texel)+3) & ~3u;
+                    }
+
+                    texture_2d->UpdateTexture(std::move(update));
+                }
+            }
+        }
+    }
+}
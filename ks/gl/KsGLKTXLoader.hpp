@@ -0,0 +1,74 @@
+/*
+   Copyright (C) 2015 Preet Desai (preet.desai@gmail.com)
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#ifndef KS_GL_KTX_LOADER_HPP
+#define KS_GL_KTX_LOADER_HPP
+
+// stl
+#include <string>
+#include <vector>
+
+// ks
+#include <ks/gl/KsGLTexture2D.hpp>
+
+namespace ks
+{
+    namespace gl
+    {
+        // Loads textures from KTX (1.1) files
+        // * Only 2D textures are supported (no arrays,
+        //   cube maps or 3D textures)
+        // * Compressed formats and the uncompressed formats
+        //   Texture2D supports can be loaded
+        namespace KTXLoader
+        {
+            struct Texture
+            {
+                Texture2D::Format format;
+                u32 width;
+                u32 height;
+
+                // list_levels[0] is the base level, followed
+                // by any mipmap levels in the file
+                std::vector<shared_ptr<ImageData const>> list_levels;
+            };
+
+            bool Load(std::string const &path,Texture &texture);
+
+            bool Load(std::vector<u8> const &data,Texture &texture);
+
+            // * Reads only the header and returns the
+            //   texture's format
+            bool GetFormat(std::string const &path,Texture2D::Format &format);
+
+            // * Given the same texture encoded in several formats,
+            //   ordered by preference (ie. ASTC, ETC1, DXT, then an
+            //   uncompressed fallback), loads the first one whose
+            //   format the GL implementation supports
+            // * Returns the index of the loaded path or -1 if
+            //   none could be loaded
+            // * Must only be called after Implementation::GLCapture
+            sint LoadBestVariant(std::vector<std::string> const &list_paths,
+                                 Texture &texture);
+
+            // * Queues ReUpload updates for every level of @texture;
+            //   @texture_2d must have been created with the same format
+            void UpdateTexture(Texture const &texture,Texture2D* texture_2d);
+        }
+    }
+}
+
+#endif // KS_GL_KTX_LOADER_HPP
@@ -0,0 +1,356 @@
+/*
+   Copyright (C) 2015 Preet Desai (preet.desai@gmail.com)
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+// stl
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <mutex>
+#include <vector>
+
+// ks
+#include <ks/KsLog.hpp>
+#include <ks/KsMiscUtils.hpp>
+#include <ks/gl/KsGLImplementation.hpp>
+#include <ks/gl/KsGLProgramBinaryCache.hpp>
+
+#if defined(KS_ENV_GL_ES)
+    #include <EGL/egl.h>
+#endif
+
+namespace ks
+{
+    namespace gl
+    {
+        namespace ProgramBinaryCache
+        {
+            namespace {
+                std::mutex g_mutex;
+                std::string g_directory;
+
+                // set from the rendering thread by IsEnabled
+                bool g_checked_support{false};
+                bool g_supported{false};
+
+                std::string g_log_prefix{"gl: ProgramBinaryCache: "};
+
+                #if defined(KS_ENV_GL_ES)
+                    PFNGLGETPROGRAMBINARYOESPROC g_glGetProgramBinary{nullptr};
+                    PFNGLPROGRAMBINARYOESPROC g_glProgramBinary{nullptr};
+                    GLenum const g_gl_program_binary_length = GL_PROGRAM_BINARY_LENGTH_OES;
+                    GLenum const g_gl_num_program_binary_formats = GL_NUM_PROGRAM_BINARY_FORMATS_OES;
+                #elif defined(KS_ENV_GL_DESKTOP)
+                    GLenum const g_gl_program_binary_length = GL_PROGRAM_BINARY_LENGTH;
+                    GLenum const g_gl_num_program_binary_formats = GL_NUM_PROGRAM_BINARY_FORMATS;
+                #endif
+
+                // Identifies cache files and their layout; bump
+                // the version if FileHeader changes
+                u32 const g_file_magic = 0x4250534B; // "KSPB"
+                u32 const g_file_version = 1;
+
+                struct FileHeader
+                {
+                    u32 magic;
+                    u32 version;
+                    u64 key;
+                    u32 format;
+                    u32 size_bytes;
+                    u64 checksum;
+                };
+
+                // 64-bit FNV-1a
+                u64 const g_fnv_offset_basis = 14695981039346656037ULL;
+                u64 const g_fnv_prime = 1099511628211ULL;
+
+                u64 hashBytes(u64 hash,void const * data,size_t size_bytes)
+                {
+                    u8 const * bytes = static_cast<u8 const *>(data);
+                    for(size_t i=0; i < size_bytes; i++) {
+                        hash ^= bytes[i];
+                        hash *= g_fnv_prime;
+                    }
+                    return hash;
+                }
+
+                u64 hashString(u64 hash,std::string const &str)
+                {
+                    // include the length so that adjacent strings
+                    // can't be shifted into each other
+                    u64 const length = str.size();
+                    hash = hashBytes(hash,&length,sizeof(length));
+                    return hashBytes(hash,str.data(),str.size());
+                }
+
+                std::string getFilePath(u64 key)
+                {
+                    char key_str[17];
+                    snprintf(key_str,sizeof(key_str),"%016llx",
+                             static_cast<unsigned long long>(key));
+
+                    std::lock_guard<std::mutex> lock(g_mutex);
+                    return g_directory+"/"+std::string(key_str)+".bin";
+                }
+
+                bool checkSupport()
+                {
+                    #if defined(KS_ENV_GL_ES)
+                        if(!Implementation::GetGLExtensionExists(
+                                "GL_OES_get_program_binary")) {
+                            return false;
+                        }
+
+                        g_glGetProgramBinary =
+                                reinterpret_cast<PFNGLGETPROGRAMBINARYOESPROC>(
+                                    eglGetProcAddress("glGetProgramBinaryOES"));
+
+                        g_glProgramBinary =
+                                reinterpret_cast<PFNGLPROGRAMBINARYOESPROC>(
+                                    eglGetProcAddress("glProgramBinaryOES"));
+
+                        if(!g_glGetProgramBinary || !g_glProgramBinary) {
+                            return false;
+                        }
+                    #elif defined(KS_ENV_GL_DESKTOP)
+                        // Core in GL 4.1, so the extension
+                        // string may not be listed
+                        if(!glGetProgramBinary || !glProgramBinary) {
+                            return false;
+                        }
+                    #endif
+
+                    // Some implementations expose the extension
+                    // but don't support any binary formats
+                    GLint num_formats=0;
+                    glGetIntegerv(g_gl_num_program_binary_formats,&num_formats);
+                    KS_CHECK_GL_ERROR(g_log_prefix+"get num binary formats");
+
+                    return (num_formats > 0);
+                }
+
+                void getProgramBinary(GLuint prog,
+                                      GLsizei size_bytes,
+                                      GLenum * format,
+                                      void * data)
+                {
+                    #if defined(KS_ENV_GL_ES)
+                        g_glGetProgramBinary(prog,size_bytes,nullptr,format,data);
+                    #elif defined(KS_ENV_GL_DESKTOP)
+                        glGetProgramBinary(prog,size_bytes,nullptr,format,data);
+                    #endif
+                }
+
+                void programBinary(GLuint prog,
+                                   GLenum format,
+                                   void const * data,
+                                   GLsizei size_bytes)
+                {
+                    #if defined(KS_ENV_GL_ES)
+                        g_glProgramBinary(prog,format,data,size_bytes);
+                    #elif defined(KS_ENV_GL_DESKTOP)
+                        glProgramBinary(prog,format,data,size_bytes);
+                    #endif
+                }
+            }
+
+            // ============================================================= //
+
+            void SetDirectory(std::string path)
+            {
+                std::lock_guard<std::mutex> lock(g_mutex);
+                g_directory = std::move(path);
+            }
+
+            std::string GetDirectory()
+            {
+                std::lock_guard<std::mutex> lock(g_mutex);
+                return g_directory;
+            }
+
+            bool IsEnabled()
+            {
+                if(GetDirectory().empty()) {
+                    return false;
+                }
+
+                if(!g_checked_support) {
+                    g_supported = checkSupport();
+                    g_checked_support = true;
+
+                    if(!g_supported) {
+                        LOG.Info() << g_log_prefix
+                                   << "program binaries not supported";
+                    }
+                }
+
+                return g_supported;
+            }
+
+            u64 CalcKey(std::string const &source_vsh,
+                        std::string const &source_fsh,
+                        std::string const &glsl_version,
+                        std::string const &attrib_bindings)
+            {
+                u64 hash = g_fnv_offset_basis;
+                hash = hashString(hash,source_vsh);
+                hash = hashString(hash,source_fsh);
+                hash = hashString(hash,glsl_version);
+                hash = hashString(hash,attrib_bindings);
+
+                // GL_VERSION includes the driver version
+                hash = hashString(hash,Implementation::GetGLVendor());
+                hash = hashString(hash,Implementation::GetGLRenderer());
+                hash = hashString(hash,Implementation::GetGLVersion());
+
+                return hash;
+            }
+
+            bool GLLoad(GLuint prog,u64 key)
+            {
+                std::string const path = getFilePath(key);
+
+                std::ifstream file(path,std::ios::in | std::ios::binary);
+                if(!file.is_open()) {
+                    return false;
+                }
+
+                FileHeader header;
+                file.read(reinterpret_cast<char*>(&header),sizeof(header));
+                if(!file ||
+                   header.magic != g_file_magic ||
+                   header.version != g_file_version ||
+                   header.key != key ||
+                   header.size_bytes == 0) {
+                    LOG.Warn() << g_log_prefix << "invalid header: " << path;
+                    return false;
+                }
+
+                std::vector<u8> binary(header.size_bytes);
+                file.read(reinterpret_cast<char*>(&(binary[0])),binary.size());
+                if(!file) {
+                    LOG.Warn() << g_log_prefix << "truncated file: " << path;
+                    return false;
+                }
+
+                if(hashBytes(g_fnv_offset_basis,&(binary[0]),binary.size()) !=
+                        header.checksum) {
+                    LOG.Warn() << g_log_prefix << "bad checksum: " << path;
+                    return false;
+                }
+
+                programBinary(prog,header.format,&(binary[0]),binary.size());
+
+                // The driver may still reject the binary, (ie. if
+                // it was updated without changing its version string)
+                // in which case GL_LINK_STATUS is false. This isn't
+                // a GL error so clear any error that was set anyway
+                while(glGetError() != GL_NO_ERROR) {}
+
+                GLint link_status = GL_FALSE;
+                glGetProgramiv(prog,GL_LINK_STATUS,&link_status);
+                if(link_status == GL_FALSE) {
+                    LOG.Info() << g_log_prefix << "binary rejected: " << path;
+                    return false;
+                }
+
+                return true;
+            }
+
+            bool GLSave(GLuint prog,u64 key)
+            {
+                GLint size_bytes=0;
+                glGetProgramiv(prog,g_gl_program_binary_length,&size_bytes);
+                KS_CHECK_GL_ERROR(g_log_prefix+"get binary length");
+
+                if(size_bytes <= 0) {
+                    return false;
+                }
+
+                std::vector<u8> binary(size_bytes);
+                GLenum format=0;
+                getProgramBinary(prog,size_bytes,&format,&(binary[0]));
+                KS_CHECK_GL_ERROR(g_log_prefix+"get binary");
+
+                FileHeader header;
+                header.magic = g_file_magic;
+                header.version = g_file_version;
+                header.key = key;
+                header.format = format;
+                header.size_bytes = binary.size();
+                header.checksum =
+                        hashBytes(g_fnv_offset_basis,&(binary[0]),binary.size());
+
+                // Write to a temporary file first; another process
+                // may be saving the same entry so make it unique
+                std::string const path = getFilePath(key);
+                std::string const path_tmp =
+                        path+"."+ConvNumberToString(
+                            std::chrono::steady_clock::now().
+                            time_since_epoch().count())+".tmp";
+
+                {
+                    std::ofstream file(path_tmp,
+                                       std::ios::out |
+                                       std::ios::binary |
+                                       std::ios::trunc);
+
+                    file.write(reinterpret_cast<char const*>(&header),
+                               sizeof(header));
+
+                    file.write(reinterpret_cast<char const*>(&(binary[0])),
+                               binary.size());
+
+                    file.close();
+
+                    if(!file) {
+                        LOG.Warn() << g_log_prefix
+                                   << "failed to write: " << path_tmp;
+                        std::remove(path_tmp.c_str());
+                        return false;
+                    }
+                }
+
+                if(std::rename(path_tmp.c_str(),path.c_str()) != 0) {
+                    // rename won't replace an existing file on
+                    // some platforms
+                    std::remove(path.c_str());
+                    if(std::rename(path_tmp.c_str(),path.c_str()) != 0) {
+                        LOG.Warn() << g_log_prefix
+                                   << "failed to rename: " << path_tmp;
+                        std::remove(path_tmp.c_str());
+                        return false;
+                    }
+                }
+
+                return true;
+            }
+
+            void GLSetRetrievableHint(GLuint prog)
+            {
+                #if defined(KS_ENV_GL_DESKTOP)
+                    if(glProgramParameteri) {
+                        glProgramParameteri(prog,
+                                            GL_PROGRAM_BINARY_RETRIEVABLE_HINT,
+                                            GL_TRUE);
+                        KS_CHECK_GL_ERROR(g_log_prefix+"set retrievable hint");
+                    }
+                #else
+                    (void)prog;
+                #endif
+            }
+        }
+    }
+}
@@ -0,0 +1,76 @@
+/*
+   Copyright (C) 2015 Preet Desai (preet.desai@gmail.com)
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#ifndef KS_GL_PROGRAM_BINARY_CACHE_HPP
+#define KS_GL_PROGRAM_BINARY_CACHE_HPP
+
+// stl
+#include <string>
+
+// ks
+#include <ks/gl/KsGLDebug.hpp>
+
+namespace ks
+{
+    namespace gl
+    {
+        // On-disk cache of linked shader program binaries
+        // * Uses GL_OES_get_program_binary (ES) or
+        //   GL_ARB_get_program_binary (desktop)
+        // * Disabled until a directory is set with SetDirectory
+        // * Entries are keyed by the shader sources and the GL
+        //   vendor, renderer and version strings, so a driver
+        //   update invalidates them
+        namespace ProgramBinaryCache
+        {
+            // * Sets the directory cache files are read from and
+            //   written to; the directory must already exist
+            // * An empty path disables the cache
+            void SetDirectory(std::string path);
+            std::string GetDirectory();
+
+            // * Returns true if a directory has been set and the
+            //   GL implementation supports program binaries
+            // * Must only be called from within an active OpenGL
+            //   context after Implementation::GLCapture
+            bool IsEnabled();
+
+            // * @attrib_bindings should identify any attribute
+            //   locations bound before linking
+            u64 CalcKey(std::string const &source_vsh,
+                        std::string const &source_fsh,
+                        std::string const &glsl_version,
+                        std::string const &attrib_bindings);
+
+            // * Sets the program binary for @key on @prog
+            // * Returns false if there's no entry for @key or if
+            //   the entry isn't valid, in which case the program
+            //   must be compiled and linked from source instead
+            bool GLLoad(GLuint prog,u64 key);
+
+            // * Saves the binary for the linked program @prog
+            // * The file is written under a temporary name and
+            //   then renamed, so a partial write is never loaded
+            bool GLSave(GLuint prog,u64 key);
+
+            // * Should be set on programs before they are linked
+            //   so their binaries can be retrieved
+            void GLSetRetrievableHint(GLuint prog);
+        }
+    }
+}
+
+#endif // KS_GL_PROGRAM_BINARY_CACHE_HPP
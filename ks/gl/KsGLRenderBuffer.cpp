@@ -0,0 +1,122 @@
+/*
+   Copyright (C) 2015 Preet Desai (preet.desai@gmail.com)
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#include <ks/gl/KsGLRenderBuffer.hpp>
+#include <ks/gl/KsGLImplementation.hpp>
+#include <ks/gl/KsGLDebug.hpp>
+
+namespace ks
+{
+    namespace gl
+    {
+        RenderBuffer::RenderBuffer(Format format,u16 width,u16 height) :
+            m_format(format),
+            m_width(width),
+            m_height(height),
+            m_renderbuffer_handle(0),
+            m_log_prefix("RenderBuffer: ")
+        {
+            #ifdef KS_ENV_GL_ES
+            if(m_format == Format::RGBA8 &&
+               !Implementation::GetGLExtensionExists("GL_OES_rgb8_rgba8")) {
+                LOG.Error() << m_log_prefix
+                            << "RGBA8 requested but GL_OES_rgb8_rgba8 N/A";
+            }
+            else if(m_format == Format::DEPTH24_STENCIL8 &&
+                    !Implementation::GetGLExtensionExists("GL_OES_packed_depth_stencil")) {
+                LOG.Error() << m_log_prefix
+                            << "Packed depth+stencil requested but "
+                               "GL_OES_packed_depth_stencil N/A";
+            }
+            #endif
+        }
+
+        RenderBuffer::~RenderBuffer()
+        {
+            // empty
+        }
+
+        GLuint RenderBuffer::GetHandle() const
+        {
+            return m_renderbuffer_handle;
+        }
+
+        RenderBuffer::Format RenderBuffer::GetFormat() const
+        {
+            return m_format;
+        }
+
+        u16 RenderBuffer::GetWidth() const
+        {
+            return m_width;
+        }
+
+        u16 RenderBuffer::GetHeight() const
+        {
+            return m_height;
+        }
+
+        u32 RenderBuffer::GetNumBytes() const
+        {
+            u32 const bpp =
+                    (m_format == Format::RGBA8) ? 4 :
+                    (m_format == Format::DEPTH24_STENCIL8) ? 4 :
+                    (m_format == Format::STENCIL_INDEX8) ? 1 : 2;
+
+            return m_width*m_height*bpp;
+        }
+
+        bool RenderBuffer::GLInit()
+        {
+            if(!(m_renderbuffer_handle == 0)) {
+                LOG.Error() << m_log_prefix
+                            << "already have valid handle: "
+                            << m_renderbuffer_handle;
+                return false;
+            }
+
+            glGenRenderbuffers(1,&m_renderbuffer_handle);
+            KS_CHECK_GL_ERROR(m_log_prefix+"gen renderbuffers");
+
+            if(m_renderbuffer_handle == 0) {
+                LOG.Error() << m_log_prefix
+                            << "failed to gen renderbuffer";
+                return false;
+            }
+
+            // Renderbuffer bindings aren't tracked by the
+            // StateSet, so restoring 0 is enough
+            glBindRenderbuffer(GL_RENDERBUFFER,m_renderbuffer_handle);
+            glRenderbufferStorage(GL_RENDERBUFFER,
+                                  static_cast<GLenum>(m_format),
+                                  m_width,
+                                  m_height);
+            glBindRenderbuffer(GL_RENDERBUFFER,0);
+
+            KS_CHECK_GL_ERROR(m_log_prefix+"renderbuffer storage");
+
+            return true;
+        }
+
+        void RenderBuffer::GLCleanUp()
+        {
+            if(!(m_renderbuffer_handle == 0)) {
+                glDeleteRenderbuffers(1,&m_renderbuffer_handle);
+                m_renderbuffer_handle = 0;
+            }
+        }
+    } // gl
+} // ks
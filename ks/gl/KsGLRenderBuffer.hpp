@@ -0,0 +1,84 @@
+/*
+   Copyright (C) 2015 Preet Desai (preet.desai@gmail.com)
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#ifndef KS_GL_RENDER_BUFFER_HPP
+#define KS_GL_RENDER_BUFFER_HPP
+
+// stl
+#include <string>
+
+// ks
+#include <ks/gl/KsGLResource.hpp>
+#include <ks/gl/KsGLConfig.hpp>
+
+// Renderbuffer formats that are extensions on one of GL 2.1 / GL ES 2
+#ifndef GL_RGBA8
+#define GL_RGBA8 0x8058 // GL_RGBA8_OES
+#endif
+
+#ifndef GL_RGB565
+#define GL_RGB565 0x8D62
+#endif
+
+#ifndef GL_DEPTH24_STENCIL8
+#define GL_DEPTH24_STENCIL8 0x88F0 // GL_DEPTH24_STENCIL8_OES
+#endif
+
+namespace ks
+{
+    namespace gl
+    {
+        // RenderBuffer
+        // * Storage for a FrameBuffer attachment that is never
+        //   sampled, ie. a depth buffer for an offscreen pass
+        class RenderBuffer : public Resource
+        {
+        public:
+            enum class Format : GLenum {
+                RGBA4 = GL_RGBA4,
+                RGB5_A1 = GL_RGB5_A1,
+                RGB565 = GL_RGB565,
+                RGBA8 = GL_RGBA8, // GL_OES_rgb8_rgba8 on GL ES 2
+                DEPTH_COMPONENT16 = GL_DEPTH_COMPONENT16,
+                STENCIL_INDEX8 = GL_STENCIL_INDEX8,
+                DEPTH24_STENCIL8 = GL_DEPTH24_STENCIL8 // GL_OES_packed_depth_stencil on GL ES 2
+            };
+
+            RenderBuffer(Format format,u16 width,u16 height);
+            ~RenderBuffer();
+
+            GLuint GetHandle() const;
+            Format GetFormat() const;
+            u16 GetWidth() const;
+            u16 GetHeight() const;
+            u32 GetNumBytes() const;
+
+            // * Creates the renderbuffer and allocates its storage
+            bool GLInit();
+            void GLCleanUp();
+
+        private:
+            Format const m_format;
+            u16 const m_width;
+            u16 const m_height;
+
+            GLuint m_renderbuffer_handle;
+            std::string m_log_prefix;
+        };
+    } // gl
+} // ks
+
+#endif // KS_GL_RENDER_BUFFER_HPP
@@ -0,0 +1,278 @@
+/*
+   Copyright (C) 2015 Preet Desai (preet.desai@gmail.com)
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+// stl
+#include <algorithm>
+
+// ks
+#include <ks/gl/KsGLRenderGraph.hpp>
+
+namespace ks
+{
+    namespace gl
+    {
+        RenderGraph::RenderGraph(GLint screen_framebuffer) :
+            m_screen_framebuffer(screen_framebuffer),
+            m_log_prefix("RenderGraph: "),
+            m_compiled(false),
+            m_physical_count(0)
+        {
+            Clear();
+        }
+
+        RenderGraph::~RenderGraph()
+        {
+            // empty
+        }
+
+        RenderGraph::TargetId RenderGraph::AddTarget(std::string name,
+                                                     RenderTargetPool::Desc const &desc)
+        {
+            m_list_targets.push_back(Target{std::move(name),desc,-1,-1,nullptr});
+            m_compiled = false;
+
+            return (m_list_targets.size()-1);
+        }
+
+        void RenderGraph::AddPass(std::string name,
+                                  std::vector<TargetId> list_inputs,
+                                  TargetId output,
+                                  PassFn execute)
+        {
+            m_list_passes.push_back(
+                        Pass{std::move(name),
+                             std::move(list_inputs),
+                             output,
+                             std::move(execute),
+                             false,
+                             {}});
+            m_compiled = false;
+        }
+
+        void RenderGraph::Clear()
+        {
+            m_list_targets.clear();
+            m_list_passes.clear();
+
+            m_list_targets.push_back(
+                        Target{"screen",RenderTargetPool::Desc{},-1,-1,nullptr});
+
+            m_compiled = false;
+            m_physical_count = 0;
+        }
+
+        bool RenderGraph::Compile()
+        {
+            m_compiled = false;
+
+            for(auto &target : m_list_targets) {
+                target.writer = -1;
+            }
+
+            // Validate and find each target's writer
+            for(uint i=0; i < m_list_passes.size(); i++) {
+                Pass &pass = m_list_passes[i];
+                pass.culled = false;
+                pass.list_release.clear();
+
+                for(TargetId input : pass.list_inputs) {
+                    if(input == Screen || input >= m_list_targets.size() ||
+                       m_list_targets[input].writer < 0) {
+                        LOG.Error() << m_log_prefix << pass.name
+                                    << ": input isn't written by an earlier pass";
+                        return false;
+                    }
+                }
+
+                if(pass.output != Screen) {
+                    if(pass.output >= m_list_targets.size()) {
+                        LOG.Error() << m_log_prefix << pass.name
+                                    << ": invalid output";
+                        return false;
+                    }
+
+                    Target &target = m_list_targets[pass.output];
+                    if(target.writer >= 0) {
+                        LOG.Error() << m_log_prefix << pass.name
+                                    << ": " << target.name
+                                    << " is already written by "
+                                    << m_list_passes[target.writer].name;
+                        return false;
+                    }
+
+                    if(std::find(pass.list_inputs.begin(),
+                                 pass.list_inputs.end(),
+                                 pass.output) != pass.list_inputs.end()) {
+                        LOG.Error() << m_log_prefix << pass.name
+                                    << ": can't read and write " << target.name;
+                        return false;
+                    }
+
+                    target.writer = i;
+                }
+            }
+
+            // Cull passes whose output isn't read; repeat since
+            // culling a pass can leave its inputs unread
+            bool culled_any = true;
+            while(culled_any) {
+                culled_any = false;
+
+                for(auto &target : m_list_targets) {
+                    target.last_reader = -1;
+                }
+
+                for(uint i=0; i < m_list_passes.size(); i++) {
+                    if(m_list_passes[i].culled) {
+                        continue;
+                    }
+                    for(TargetId input : m_list_passes[i].list_inputs) {
+                        m_list_targets[input].last_reader = i;
+                    }
+                }
+
+                for(auto &pass : m_list_passes) {
+                    if(!pass.culled && pass.output != Screen &&
+                       m_list_targets[pass.output].last_reader < 0) {
+                        pass.culled = true;
+                        culled_any = true;
+                    }
+                }
+            }
+
+            // Release each target after its last read, and count
+            // the pool targets needed by simulating the pool
+            std::vector<RenderTargetPool::Desc> list_free;
+            m_physical_count = 0;
+
+            for(uint i=0; i < m_list_passes.size(); i++) {
+                Pass &pass = m_list_passes[i];
+                if(pass.culled) {
+                    continue;
+                }
+
+                if(pass.output != Screen) {
+                    auto const &desc = m_list_targets[pass.output].desc;
+                    auto it = std::find(list_free.begin(),list_free.end(),desc);
+                    if(it != list_free.end()) {
+                        list_free.erase(it);
+                    }
+                    else {
+                        m_physical_count++;
+                    }
+                }
+
+                for(TargetId input : pass.list_inputs) {
+                    if(m_list_targets[input].last_reader == static_cast<sint>(i) &&
+                       std::find(pass.list_release.begin(),
+                                 pass.list_release.end(),
+                                 input) == pass.list_release.end()) {
+                        pass.list_release.push_back(input);
+                        list_free.push_back(m_list_targets[input].desc);
+                    }
+                }
+            }
+
+            m_compiled = true;
+            return true;
+        }
+
+        bool RenderGraph::GLExecute(StateSet* state_set,RenderTargetPool* pool)
+        {
+            if(!m_compiled) {
+                LOG.Error() << m_log_prefix << "graph must be compiled first";
+                return false;
+            }
+
+            // Passes that render to the screen use the viewport
+            // the caller set up rather than the last target's
+            auto const viewport = state_set->GetViewport();
+            StateSet::Rect screen_viewport = viewport.value;
+            if(!viewport.valid) {
+                GLint vp[4];
+                glGetIntegerv(GL_VIEWPORT,vp);
+                screen_viewport = StateSet::Rect{vp[0],vp[1],vp[2],vp[3]};
+            }
+
+            bool ok = true;
+            PassResources resources;
+
+            for(auto &pass : m_list_passes) {
+                if(pass.culled) {
+                    continue;
+                }
+
+                resources.list_inputs.clear();
+                for(TargetId input : pass.list_inputs) {
+                    Target const &target = m_list_targets[input];
+                    resources.list_inputs.push_back(
+                                target.physical ? target.physical->color.get() : nullptr);
+                }
+
+                if(pass.output == Screen) {
+                    state_set->SetFrameBuffer(m_screen_framebuffer);
+                    state_set->SetViewport(screen_viewport.x,
+                                           screen_viewport.y,
+                                           screen_viewport.width,
+                                           screen_viewport.height);
+                    resources.framebuffer = nullptr;
+                    resources.output = nullptr;
+                }
+                else {
+                    Target &target = m_list_targets[pass.output];
+                    target.physical = pool->GLAcquire(state_set,target.desc);
+                    if(!target.physical) {
+                        LOG.Error() << m_log_prefix << pass.name
+                                    << ": failed to acquire " << target.name;
+                        ok = false;
+                        break;
+                    }
+
+                    state_set->SetViewport(0,0,target.desc.width,target.desc.height);
+                    resources.framebuffer = target.physical->framebuffer.get();
+                    resources.output = target.physical->color.get();
+                }
+
+                pass.execute(state_set,resources);
+
+                for(TargetId id : pass.list_release) {
+                    pool->Release(m_list_targets[id].physical);
+                    m_list_targets[id].physical = nullptr;
+                }
+            }
+
+            // Release anything left over after a failure
+            for(auto &target : m_list_targets) {
+                if(target.physical) {
+                    pool->Release(target.physical);
+                    target.physical = nullptr;
+                }
+            }
+
+            state_set->SetViewport(screen_viewport.x,
+                                   screen_viewport.y,
+                                   screen_viewport.width,
+                                   screen_viewport.height);
+
+            return ok;
+        }
+
+        uint RenderGraph::GetPhysicalTargetCount() const
+        {
+            return m_physical_count;
+        }
+    } // gl
+} // ks
@@ -0,0 +1,140 @@
+/*
+   Copyright (C) 2015 Preet Desai (preet.desai@gmail.com)
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#ifndef KS_GL_RENDER_GRAPH_HPP
+#define KS_GL_RENDER_GRAPH_HPP
+
+// stl
+#include <functional>
+#include <string>
+#include <vector>
+
+// ks
+#include <ks/gl/KsGLRenderTargetPool.hpp>
+
+namespace ks
+{
+    namespace gl
+    {
+        // RenderGraph
+        // * Schedules a chain of render passes (ie. post processing)
+        //   that declare the targets they read and write, instead of
+        //   each pass owning its own intermediate textures
+        // * Compile works out how long each target is needed, from
+        //   the pass that writes it to the last pass that reads it.
+        //   GLExecute acquires a target from a RenderTargetPool just
+        //   before it's written and releases it after its last read,
+        //   so targets with the same Desc whose lifetimes don't
+        //   overlap share the same texture and framebuffer
+        // * Passes whose output is never read are culled
+        // * Must only be used from the rendering thread
+        class RenderGraph final
+        {
+        public:
+            using TargetId = uint;
+
+            // * A pass without an output renders to the screen
+            static TargetId const Screen = 0;
+
+            struct PassResources
+            {
+                // * The output's framebuffer, which is bound with the
+                //   viewport set to its size before the pass runs.
+                //   nullptr when rendering to the screen, in which
+                //   case the viewport GLExecute was called with is set
+                FrameBuffer* framebuffer;
+                Texture2D* output;
+
+                // * Color textures for the pass inputs, in the order
+                //   they were declared
+                std::vector<Texture2D*> list_inputs;
+            };
+
+            using PassFn = std::function<void(StateSet*,PassResources const &)>;
+
+            // * @screen_framebuffer is bound for passes that render
+            //   to the screen; it isn't 0 on some platforms (ie. iOS)
+            RenderGraph(GLint screen_framebuffer=0);
+            ~RenderGraph();
+
+            // * Declares a transient target; its contents only live
+            //   from the pass that writes it to the last that reads it
+            TargetId AddTarget(std::string name,RenderTargetPool::Desc const &desc);
+
+            // * Passes run in the order they're added; every input
+            //   must be written by an earlier pass
+            void AddPass(std::string name,
+                         std::vector<TargetId> list_inputs,
+                         TargetId output,
+                         PassFn execute);
+
+            // * Removes all targets and passes
+            void Clear();
+
+            // * Validates the graph, culls unused passes and computes
+            //   target lifetimes; must be called after the graph
+            //   changes and before GLExecute
+            bool Compile();
+
+            // * Runs the passes that weren't culled, acquiring and
+            //   releasing their targets from @pool
+            // * The viewport is restored before returning
+            bool GLExecute(StateSet* state_set,RenderTargetPool* pool);
+
+            // * Number of pool targets the compiled graph needs
+            //   at once, assuming the pool starts out empty
+            uint GetPhysicalTargetCount() const;
+
+        private:
+            struct Target
+            {
+                std::string name;
+                RenderTargetPool::Desc desc;
+
+                // set by Compile
+                sint writer;
+                sint last_reader;
+
+                // set while executing
+                RenderTargetPool::RenderTarget* physical;
+            };
+
+            struct Pass
+            {
+                std::string name;
+                std::vector<TargetId> list_inputs;
+                TargetId output;
+                PassFn execute;
+
+                // set by Compile
+                bool culled;
+                std::vector<TargetId> list_release;
+            };
+
+            GLint const m_screen_framebuffer;
+            std::string const m_log_prefix;
+
+            bool m_compiled;
+            uint m_physical_count;
+
+            // m_list_targets[0] is the Screen placeholder
+            std::vector<Target> m_list_targets;
+            std::vector<Pass> m_list_passes;
+        };
+    } // gl
+} // ks
+
+#endif // KS_GL_RENDER_GRAPH_HPP
@@ -0,0 +1,191 @@
+/*
+   Copyright (C) 2015 Preet Desai (preet.desai@gmail.com)
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+// stl
+#include <algorithm>
+
+// ks
+#include <ks/gl/KsGLImageUtils.hpp>
+#include <ks/gl/KsGLRenderTargetPool.hpp>
+
+namespace ks
+{
+    namespace gl
+    {
+        bool RenderTargetPool::Desc::operator == (Desc const &other) const
+        {
+            return (width == other.width &&
+                    height == other.height &&
+                    color_format == other.color_format &&
+                    depth == other.depth);
+        }
+
+        // ============================================================= //
+
+        RenderTargetPool::RenderTargetPool(uint max_unused_frames) :
+            m_max_unused_frames(max_unused_frames),
+            m_log_prefix("RenderTargetPool: "),
+            m_frame(0)
+        {
+            // empty
+        }
+
+        RenderTargetPool::~RenderTargetPool()
+        {
+            // empty
+        }
+
+        RenderTargetPool::RenderTarget*
+        RenderTargetPool::GLAcquire(StateSet* state_set,Desc const &desc)
+        {
+            for(auto &slot : m_list_slots) {
+                if(!slot.in_use && slot.target->desc == desc) {
+                    slot.in_use = true;
+                    slot.last_used = m_frame;
+                    slot.target->framebuffer->GLBind(state_set);
+                    return slot.target.get();
+                }
+            }
+
+            unique_ptr<RenderTarget> target = glCreateTarget(state_set,desc);
+            if(!target) {
+                return nullptr;
+            }
+
+            m_list_slots.push_back(Slot{std::move(target),true,m_frame});
+            return m_list_slots.back().target.get();
+        }
+
+        void RenderTargetPool::Release(RenderTarget* target)
+        {
+            for(auto &slot : m_list_slots) {
+                if(slot.target.get() == target) {
+                    slot.in_use = false;
+                    return;
+                }
+            }
+        }
+
+        void RenderTargetPool::GLNextFrame(StateSet* state_set)
+        {
+            auto it = std::remove_if(
+                        m_list_slots.begin(),
+                        m_list_slots.end(),
+                        [this,state_set](Slot &slot) {
+                            if(slot.in_use ||
+                               (m_frame - slot.last_used < m_max_unused_frames)) {
+                                return false;
+                            }
+                            glDestroyTarget(state_set,*(slot.target));
+                            return true;
+                        });
+
+            m_list_slots.erase(it,m_list_slots.end());
+            m_frame++;
+        }
+
+        void RenderTargetPool::GLCleanUp(StateSet* state_set)
+        {
+            for(auto &slot : m_list_slots) {
+                glDestroyTarget(state_set,*(slot.target));
+            }
+            m_list_slots.clear();
+        }
+
+        uint RenderTargetPool::GetTargetCount() const
+        {
+            return m_list_slots.size();
+        }
+
+        u32 RenderTargetPool::GetNumBytes() const
+        {
+            u32 num_bytes = 0;
+            for(auto const &slot : m_list_slots) {
+                num_bytes += slot.target->color->GetNumBytes();
+                if(slot.target->depth) {
+                    num_bytes += slot.target->depth->GetNumBytes();
+                }
+            }
+            return num_bytes;
+        }
+
+        unique_ptr<RenderTargetPool::RenderTarget>
+        RenderTargetPool::glCreateTarget(StateSet* state_set,Desc const &desc)
+        {
+            auto target = make_unique<RenderTarget>();
+            target->desc = desc;
+
+            // Allocate the color texture without data
+            target->color = make_unique<Texture2D>(desc.color_format);
+            target->color->SetFilterModes(Texture2D::Filter::Linear,
+                                          Texture2D::Filter::Linear);
+            target->color->GLInit();
+            target->color->UpdateTexture(
+                        Texture2D::Update{
+                            Texture2D::Update::ReUpload,
+                            glm::u16vec2(0,0),
+                            make_shared<EmptyImageData>(desc.width,desc.height)
+                        });
+            target->color->GLBind(state_set,0);
+            target->color->GLSync(state_set);
+
+            if(desc.depth != Depth::None) {
+                target->depth = make_unique<RenderBuffer>(
+                            (desc.depth == Depth::Depth16) ?
+                                RenderBuffer::Format::DEPTH_COMPONENT16 :
+                                RenderBuffer::Format::DEPTH24_STENCIL8,
+                            desc.width,
+                            desc.height);
+                target->depth->GLInit();
+            }
+
+            target->framebuffer = make_unique<FrameBuffer>();
+            target->framebuffer->GLInit();
+            target->framebuffer->GLAttach(state_set,
+                                          FrameBuffer::Attachment::Color,
+                                          target->color.get());
+            if(target->depth) {
+                target->framebuffer->GLAttach(
+                            state_set,
+                            (desc.depth == Depth::Depth16) ?
+                                FrameBuffer::Attachment::Depth :
+                                FrameBuffer::Attachment::DepthStencil,
+                            target->depth.get());
+            }
+
+            if(!target->framebuffer->GLCheckComplete(state_set)) {
+                LOG.Error() << m_log_prefix << "failed to create "
+                            << desc.width << "x" << desc.height
+                            << " render target";
+                target->framebuffer->GLUnbind(state_set);
+                glDestroyTarget(state_set,*target);
+                return nullptr;
+            }
+
+            return target;
+        }
+
+        void RenderTargetPool::glDestroyTarget(StateSet* state_set,
+                                               RenderTarget &target)
+        {
+            target.framebuffer->GLCleanUp(state_set);
+            target.color->GLCleanUp();
+            if(target.depth) {
+                target.depth->GLCleanUp();
+            }
+        }
+    } // gl
+} // ks
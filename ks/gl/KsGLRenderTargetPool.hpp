@@ -0,0 +1,111 @@
+/*
+   Copyright (C) 2015 Preet Desai (preet.desai@gmail.com)
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#ifndef KS_GL_RENDER_TARGET_POOL_HPP
+#define KS_GL_RENDER_TARGET_POOL_HPP
+
+// stl
+#include <vector>
+
+// ks
+#include <ks/gl/KsGLFrameBuffer.hpp>
+
+namespace ks
+{
+    namespace gl
+    {
+        // RenderTargetPool
+        // * Hands out offscreen render targets (a FrameBuffer with
+        //   a color texture and an optional depth renderbuffer) and
+        //   reuses released targets of the same size and formats,
+        //   so passes within a frame can share them
+        // * Targets that go unused for a few frames are destroyed
+        // * Must only be used from the rendering thread
+        class RenderTargetPool final
+        {
+        public:
+            enum class Depth : u8 {
+                None,
+                Depth16,
+                Depth24Stencil8
+            };
+
+            struct Desc
+            {
+                u16 width;
+                u16 height;
+                Texture2D::Format color_format;
+                Depth depth;
+
+                bool operator == (Desc const &other) const;
+            };
+
+            struct RenderTarget
+            {
+                Desc desc;
+                unique_ptr<FrameBuffer> framebuffer;
+                unique_ptr<Texture2D> color;
+                unique_ptr<RenderBuffer> depth; // nullptr for Depth::None
+            };
+
+            // * Targets that haven't been acquired for
+            //   @max_unused_frames frames are destroyed
+            RenderTargetPool(uint max_unused_frames=2);
+            ~RenderTargetPool();
+
+            // * Returns a released target matching @desc or creates
+            //   one; returns nullptr if it can't be made complete
+            // * The target's framebuffer is left bound
+            RenderTarget* GLAcquire(StateSet* state_set,Desc const &desc);
+
+            // * Makes @target available to later GLAcquire calls;
+            //   its contents are kept but shouldn't be relied on
+            void Release(RenderTarget* target);
+
+            // * Should be called at the end of each frame; destroys
+            //   released targets that have gone unused too long
+            void GLNextFrame(StateSet* state_set);
+
+            void GLCleanUp(StateSet* state_set);
+
+            uint GetTargetCount() const;
+
+            // * Memory used by all of the targets, in use or not
+            u32 GetNumBytes() const;
+
+        private:
+            struct Slot
+            {
+                unique_ptr<RenderTarget> target;
+                bool in_use;
+                u64 last_used;
+            };
+
+            unique_ptr<RenderTarget> glCreateTarget(StateSet* state_set,
+                                                    Desc const &desc);
+
+            void glDestroyTarget(StateSet* state_set,RenderTarget &target);
+
+            uint const m_max_unused_frames;
+            std::string const m_log_prefix;
+
+            u64 m_frame;
+            std::vector<Slot> m_list_slots;
+        };
+    } // gl
+} // ks
+
+#endif // KS_GL_RENDER_TARGET_POOL_HPP
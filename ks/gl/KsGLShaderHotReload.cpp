@@ -0,0 +1,338 @@
+/*
+   Copyright (C) 2015 Preet Desai (preet.desai@gmail.com)
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+// stl
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+
+// ks
+#include <ks/gl/KsGLShaderHotReload.hpp>
+
+#ifdef __linux__
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+namespace ks
+{
+    namespace gl
+    {
+        namespace
+        {
+            // How often the watcher thread checks whether
+            // it should stop, in milliseconds
+            int const g_poll_timeout_ms = 100;
+
+            bool readFile(std::string const &path,std::string &contents)
+            {
+                std::ifstream file(path,std::ios::in | std::ios::binary);
+                if(!file.is_open()) {
+                    return false;
+                }
+
+                std::ostringstream ss;
+                ss << file.rdbuf();
+                contents = ss.str();
+                return true;
+            }
+        }
+
+        // ============================================================= //
+
+        ShaderHotReload::ShaderHotReload() :
+            m_log_prefix("ShaderHotReload: "),
+            m_inotify_fd(-1),
+            m_running(false),
+            m_changed(false)
+        {
+            #ifdef __linux__
+                m_inotify_fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+                if(m_inotify_fd < 0) {
+                    LOG.Error() << m_log_prefix << "inotify_init failed: "
+                                << std::strerror(errno);
+                    return;
+                }
+
+                m_running = true;
+                m_thread = std::thread(&ShaderHotReload::watch,this);
+            #else
+                LOG.Error() << m_log_prefix << "not supported on this platform";
+            #endif
+        }
+
+        ShaderHotReload::~ShaderHotReload()
+        {
+            m_running = false;
+            if(m_thread.joinable()) {
+                m_thread.join();
+            }
+
+            #ifdef __linux__
+                // closing the instance removes all of its watches
+                if(m_inotify_fd >= 0) {
+                    close(m_inotify_fd);
+                }
+            #endif
+        }
+
+        shared_ptr<ShaderProgram> ShaderHotReload::GLCreateProgram(
+                std::string path_vsh,
+                std::string path_fsh,
+                std::string glsl_version)
+        {
+            std::string source_vsh;
+            std::string source_fsh;
+            if(!readFile(path_vsh,source_vsh) ||
+               !readFile(path_fsh,source_fsh)) {
+                LOG.Error() << m_log_prefix << "failed to read sources: "
+                            << path_vsh << ", " << path_fsh;
+                return nullptr;
+            }
+
+            shared_ptr<ShaderProgram> program =
+                    make_shared<ShaderProgram>(
+                        std::move(source_vsh),
+                        std::move(source_fsh),
+                        std::move(glsl_version));
+
+            program->SetDesc(path_vsh+", "+path_fsh);
+
+            if(!program->GLInit()) {
+                return nullptr;
+            }
+
+            Watch(program,std::move(path_vsh),std::move(path_fsh));
+
+            return program;
+        }
+
+        bool ShaderHotReload::Watch(shared_ptr<ShaderProgram> const &program,
+                                    std::string path_vsh,
+                                    std::string path_fsh)
+        {
+            Entry entry;
+            entry.program = program;
+            entry.program_ptr = program.get();
+            entry.changed = false;
+
+            if(!addWatch(std::move(path_vsh),entry.vsh) ||
+               !addWatch(std::move(path_fsh),entry.fsh)) {
+                return false;
+            }
+
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_list_entries.push_back(std::move(entry));
+
+            return true;
+        }
+
+        void ShaderHotReload::Unwatch(ShaderProgram* program)
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+
+            m_list_entries.erase(
+                        std::remove_if(
+                            m_list_entries.begin(),
+                            m_list_entries.end(),
+                            [program](Entry const &entry) -> bool {
+                                return (entry.program_ptr == program);
+                            }),
+                        m_list_entries.end());
+        }
+
+        uint ShaderHotReload::GLUpdate(StateSet* state_set)
+        {
+            if(!m_changed.exchange(false)) {
+                return 0;
+            }
+
+            struct Pending
+            {
+                shared_ptr<ShaderProgram> program;
+                std::string source_vsh;
+                std::string source_fsh;
+            };
+
+            std::vector<Pending> list_pending;
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+
+                auto it = m_list_entries.begin();
+                while(it != m_list_entries.end()) {
+                    shared_ptr<ShaderProgram> program = it->program.lock();
+                    if(!program) {
+                        it = m_list_entries.erase(it);
+                        continue;
+                    }
+
+                    if(it->changed) {
+                        list_pending.push_back(
+                                    Pending{std::move(program),
+                                            std::move(it->source_vsh),
+                                            std::move(it->source_fsh)});
+                        it->changed = false;
+                    }
+                    ++it;
+                }
+            }
+
+            // Build outside of the lock so the watcher
+            // thread isn't held up by the compiler
+            uint reloaded = 0;
+            for(auto &pending : list_pending) {
+                if(pending.program->GLReload(state_set,
+                                             std::move(pending.source_vsh),
+                                             std::move(pending.source_fsh))) {
+                    LOG.Info() << m_log_prefix << "reloaded "
+                               << pending.program->GetDesc();
+                    reloaded++;
+                }
+            }
+
+            return reloaded;
+        }
+
+        bool ShaderHotReload::addWatch(std::string path,File &file)
+        {
+            // The directory is watched instead of the file since
+            // many editors save by writing a new file and renaming
+            // it over the old one
+            size_t const sep_idx = path.rfind('/');
+            if(sep_idx == std::string::npos) {
+                file.dir = ".";
+                file.name = path;
+            }
+            else {
+                file.dir = (sep_idx == 0) ? "/" : path.substr(0,sep_idx);
+                file.name = path.substr(sep_idx+1);
+            }
+            file.path = std::move(path);
+
+            #ifdef __linux__
+                if(m_inotify_fd < 0) {
+                    return false;
+                }
+
+                // Watching the same directory more than once
+                // returns the existing watch descriptor
+                file.watch_desc = inotify_add_watch(m_inotify_fd,
+                                                    file.dir.c_str(),
+                                                    IN_CLOSE_WRITE | IN_MOVED_TO);
+                if(file.watch_desc < 0) {
+                    LOG.Error() << m_log_prefix << "failed to watch "
+                                << file.dir << ": " << std::strerror(errno);
+                    return false;
+                }
+
+                return true;
+            #else
+                file.watch_desc = -1;
+                return false;
+            #endif
+        }
+
+        void ShaderHotReload::watch()
+        {
+            #ifdef __linux__
+                alignas(inotify_event) char buffer[4096];
+
+                pollfd poll_fd;
+                poll_fd.fd = m_inotify_fd;
+                poll_fd.events = POLLIN;
+
+                struct Changed
+                {
+                    ShaderProgram* program_ptr;
+                    std::string path_vsh;
+                    std::string path_fsh;
+                };
+
+                std::vector<std::pair<int,std::string>> list_events;
+                std::vector<Changed> list_changed;
+
+                while(m_running) {
+                    poll_fd.revents = 0;
+                    if(poll(&poll_fd,1,g_poll_timeout_ms) <= 0) {
+                        continue;
+                    }
+
+                    ssize_t const length = read(m_inotify_fd,buffer,sizeof(buffer));
+                    if(length <= 0) {
+                        continue;
+                    }
+
+                    list_events.clear();
+                    for(char * ptr = buffer; ptr < buffer+length; ) {
+                        inotify_event const * event =
+                                reinterpret_cast<inotify_event const *>(ptr);
+
+                        if(event->len > 0) {
+                            list_events.emplace_back(event->wd,event->name);
+                        }
+                        ptr += sizeof(inotify_event)+event->len;
+                    }
+
+                    auto matches = [&list_events](File const &file) -> bool {
+                        return std::find(list_events.begin(),
+                                         list_events.end(),
+                                         std::make_pair(file.watch_desc,file.name))
+                                != list_events.end();
+                    };
+
+                    list_changed.clear();
+                    {
+                        std::lock_guard<std::mutex> lock(m_mutex);
+                        for(auto const &entry : m_list_entries) {
+                            if(matches(entry.vsh) || matches(entry.fsh)) {
+                                list_changed.push_back(
+                                            Changed{entry.program_ptr,
+                                                    entry.vsh.path,
+                                                    entry.fsh.path});
+                            }
+                        }
+                    }
+
+                    // Read the new sources without holding the lock
+                    for(auto &changed : list_changed) {
+                        std::string source_vsh;
+                        std::string source_fsh;
+                        if(!readFile(changed.path_vsh,source_vsh) ||
+                           !readFile(changed.path_fsh,source_fsh)) {
+                            // ie. the file is mid-rename; a later
+                            // event will pick up the final version
+                            continue;
+                        }
+
+                        std::lock_guard<std::mutex> lock(m_mutex);
+                        for(auto &entry : m_list_entries) {
+                            if(entry.program_ptr == changed.program_ptr) {
+                                entry.source_vsh = std::move(source_vsh);
+                                entry.source_fsh = std::move(source_fsh);
+                                entry.changed = true;
+                                m_changed = true;
+                                break;
+                            }
+                        }
+                    }
+                }
+            #endif
+        }
+    }
+}
@@ -0,0 +1,115 @@
+/*
+   Copyright (C) 2015 Preet Desai (preet.desai@gmail.com)
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#ifndef KS_GL_SHADER_HOT_RELOAD_HPP
+#define KS_GL_SHADER_HOT_RELOAD_HPP
+
+// stl
+#include <atomic>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// ks
+#include <ks/gl/KsGLShaderProgram.hpp>
+
+namespace ks
+{
+    namespace gl
+    {
+        // ShaderHotReload
+        // * Rebuilds ShaderPrograms when their source files change
+        // * Only built with KS_GL_SHADER_HOT_RELOAD defined
+        //   (CONFIG += ks_gl_shader_hot_reload); without it
+        //   nothing is watched and nothing is added per frame
+        // * Files are watched with inotify on a background thread,
+        //   which also reads the changed sources. Programs are only
+        //   rebuilt and swapped in GLUpdate, on the rendering thread
+        // * A program that fails to build keeps its current version
+        // * Linux only
+        class ShaderHotReload final
+        {
+        public:
+            ShaderHotReload();
+            ~ShaderHotReload();
+
+            // * Reads the sources from @path_vsh and @path_fsh,
+            //   builds the program and watches the files
+            // * Returns nullptr if either file can't be read or
+            //   the program fails to build
+            shared_ptr<ShaderProgram> GLCreateProgram(
+                    std::string path_vsh,
+                    std::string path_fsh,
+                    std::string glsl_version="");
+
+            // * Reloads @program from @path_vsh and @path_fsh
+            //   whenever either file changes
+            // * Programs are held weakly; entries for programs that
+            //   have been destroyed are dropped
+            bool Watch(shared_ptr<ShaderProgram> const &program,
+                       std::string path_vsh,
+                       std::string path_fsh);
+
+            void Unwatch(ShaderProgram* program);
+
+            // * Rebuilds every program whose sources changed since
+            //   the last call; should be called at a frame boundary
+            // * Returns the number of programs that were reloaded
+            uint GLUpdate(StateSet* state_set);
+
+        private:
+            struct File
+            {
+                int watch_desc;
+                std::string dir;
+                std::string name;
+                std::string path;
+            };
+
+            struct Entry
+            {
+                std::weak_ptr<ShaderProgram> program;
+                ShaderProgram* program_ptr;
+                File vsh;
+                File fsh;
+
+                // set by the watcher thread
+                bool changed;
+                std::string source_vsh;
+                std::string source_fsh;
+            };
+
+            bool addWatch(std::string path,File &file);
+            void watch();
+
+            std::string const m_log_prefix;
+
+            int m_inotify_fd;
+            std::atomic<bool> m_running;
+            std::thread m_thread;
+
+            // set when any entry has changed so GLUpdate
+            // doesn't need to lock otherwise
+            std::atomic<bool> m_changed;
+
+            std::mutex m_mutex;
+            std::vector<Entry> m_list_entries;
+        };
+    }
+}
+
+#endif // KS_GL_SHADER_HOT_RELOAD_HPP
@@ -0,0 +1,221 @@
+/*
+   Copyright (C) 2015 Preet Desai (preet.desai@gmail.com)
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+// stl
+#include <algorithm>
+#include <sstream>
+
+// ks
+#include <ks/gl/KsGLShaderLibrary.hpp>
+
+namespace ks
+{
+    namespace gl
+    {
+        namespace
+        {
+            std::string const g_precision_source_name = "ks_precision.glsl";
+
+            std::string const g_precision_source =
+                    "#ifdef GL_ES\n"
+                    "    #ifdef KS_FRAGMENT_SHADER\n"
+                    "        precision mediump float;\n"
+                    "    #endif\n"
+                    "#else\n"
+                    "    #define lowp\n"
+                    "    #define mediump\n"
+                    "    #define highp\n"
+                    "#endif\n";
+
+            std::string const g_include_directive = "#include";
+
+            // * Returns true if @line is an include directive and
+            //   sets @name to the quoted name
+            bool parseInclude(std::string const &line,std::string &name)
+            {
+                size_t const start = line.find_first_not_of(" \t");
+                if(start == std::string::npos ||
+                   line.compare(start,g_include_directive.size(),g_include_directive) != 0) {
+                    return false;
+                }
+
+                size_t const name_start = line.find('"',start+g_include_directive.size());
+                if(name_start == std::string::npos) {
+                    return false;
+                }
+
+                size_t const name_end = line.find('"',name_start+1);
+                if(name_end == std::string::npos) {
+                    return false;
+                }
+
+                name = line.substr(name_start+1,name_end-name_start-1);
+                return true;
+            }
+        }
+
+        // ============================================================= //
+
+        ShaderLibrary::ShaderLibrary(std::string glsl_version) :
+            m_glsl_version(std::move(glsl_version)),
+            m_log_prefix("ShaderLibrary: ")
+        {
+            AddSource(g_precision_source_name,g_precision_source);
+        }
+
+        ShaderLibrary::~ShaderLibrary()
+        {
+            // empty
+        }
+
+        void ShaderLibrary::AddSource(std::string name,std::string source)
+        {
+            m_lkup_sources[std::move(name)] = std::move(source);
+        }
+
+        bool ShaderLibrary::GetSourceExists(std::string const &name) const
+        {
+            return (m_lkup_sources.find(name) != m_lkup_sources.end());
+        }
+
+        bool ShaderLibrary::Preprocess(std::string const &name,
+                                       Defines const &defines,
+                                       std::string &output) const
+        {
+            output.clear();
+            for(auto const &define : defines) {
+                output += "#define "+define.first+" "+define.second+"\n";
+            }
+
+            std::vector<std::string> list_included;
+            return preprocess(name,list_included,output);
+        }
+
+        shared_ptr<ShaderProgram> ShaderLibrary::GLGetProgram(
+                std::string const &vsh_name,
+                std::string const &fsh_name,
+                Defines const &defines)
+        {
+            // Defines are sorted by name so the
+            // key doesn't depend on insertion order
+            std::string variant_key = vsh_name+'\0'+fsh_name+'\0';
+            for(auto const &define : defines) {
+                variant_key += define.first+'='+define.second+'\0';
+            }
+
+            auto variant_it = m_lkup_programs_by_variant.find(variant_key);
+            if(variant_it != m_lkup_programs_by_variant.end()) {
+                return variant_it->second;
+            }
+
+            Defines defines_vsh = defines;
+            defines_vsh["KS_VERTEX_SHADER"] = "1";
+
+            Defines defines_fsh = defines;
+            defines_fsh["KS_FRAGMENT_SHADER"] = "1";
+
+            std::string source_vsh;
+            std::string source_fsh;
+            if(!Preprocess(vsh_name,defines_vsh,source_vsh) ||
+               !Preprocess(fsh_name,defines_fsh,source_fsh)) {
+                return nullptr;
+            }
+
+            // Different variants may preprocess to the same
+            // source (ie. if a define isn't used)
+            std::string content_key =
+                    ConvNumberToString(source_vsh.size())+':'+
+                    source_vsh+source_fsh;
+
+            auto content_it = m_lkup_programs_by_content.find(content_key);
+            if(content_it != m_lkup_programs_by_content.end()) {
+                m_lkup_programs_by_variant.emplace(
+                            std::move(variant_key),content_it->second);
+
+                return content_it->second;
+            }
+
+            shared_ptr<ShaderProgram> program =
+                    make_shared<ShaderProgram>(
+                        std::move(source_vsh),
+                        std::move(source_fsh),
+                        m_glsl_version);
+
+            if(!program->GLInit()) {
+                LOG.Error() << m_log_prefix << "failed to build program: "
+                            << vsh_name << ", " << fsh_name;
+                return nullptr;
+            }
+
+            m_lkup_programs_by_variant.emplace(std::move(variant_key),program);
+            m_lkup_programs_by_content.emplace(std::move(content_key),program);
+
+            return program;
+        }
+
+        uint ShaderLibrary::GetProgramCount() const
+        {
+            return m_lkup_programs_by_content.size();
+        }
+
+        void ShaderLibrary::GLCleanUp()
+        {
+            for(auto &content_program : m_lkup_programs_by_content) {
+                content_program.second->GLCleanUp();
+            }
+
+            m_lkup_programs_by_variant.clear();
+            m_lkup_programs_by_content.clear();
+        }
+
+        bool ShaderLibrary::preprocess(std::string const &name,
+                                       std::vector<std::string> &list_included,
+                                       std::string &output) const
+        {
+            auto source_it = m_lkup_sources.find(name);
+            if(source_it == m_lkup_sources.end()) {
+                LOG.Error() << m_log_prefix << "no source named: " << name;
+                return false;
+            }
+
+            list_included.push_back(name);
+
+            std::istringstream ss(source_it->second);
+            std::string line;
+            std::string include_name;
+
+            while(std::getline(ss,line)) {
+                if(parseInclude(line,include_name)) {
+                    bool const included =
+                            std::find(list_included.begin(),
+                                      list_included.end(),
+                                      include_name) != list_included.end();
+
+                    if(!included &&
+                       !preprocess(include_name,list_included,output)) {
+                        return false;
+                    }
+                }
+                else {
+                    output += line;
+                    output += '\n';
+                }
+            }
+
+            return true;
+        }
+    }
+}
@@ -0,0 +1,101 @@
+/*
+   Copyright (C) 2015 Preet Desai (preet.desai@gmail.com)
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#ifndef KS_GL_SHADER_LIBRARY_HPP
+#define KS_GL_SHADER_LIBRARY_HPP
+
+// stl
+#include <map>
+#include <string>
+#include <unordered_map>
+
+// ks
+#include <ks/gl/KsGLShaderProgram.hpp>
+
+namespace ks
+{
+    namespace gl
+    {
+        // ShaderLibrary
+        // * Holds named GLSL sources and builds ShaderPrograms
+        //   from them with includes resolved and defines injected
+        // * Programs are cached per variant (sources + defines)
+        //   and by their preprocessed content, so any variant
+        //   that ends up with identical source is only compiled
+        //   and linked once
+        // * Must only be used from the rendering thread
+        //
+        // Preprocessing:
+        // * '#include "name"' lines are replaced with the source
+        //   added under name. Each source is included at most once
+        //   per shader, so include guards aren't needed
+        // * Defines are inserted at the top of the source, along
+        //   with KS_VERTEX_SHADER or KS_FRAGMENT_SHADER
+        // * The built-in source "ks_precision.glsl" sets a default
+        //   float precision for fragment shaders on GL ES and
+        //   defines the precision qualifiers away on desktop GL
+        class ShaderLibrary final
+        {
+        public:
+            using Defines = std::map<std::string,std::string>;
+
+            ShaderLibrary(std::string glsl_version="");
+            ~ShaderLibrary();
+
+            // * Adds or replaces the source for @name; programs
+            //   that were already built aren't affected
+            void AddSource(std::string name,std::string source);
+            bool GetSourceExists(std::string const &name) const;
+
+            // * Returns false and logs an error if @name or
+            //   any of its includes haven't been added
+            bool Preprocess(std::string const &name,
+                            Defines const &defines,
+                            std::string &output) const;
+
+            // * Returns the linked program for the given variant,
+            //   building it if it doesn't exist yet
+            // * Returns nullptr if preprocessing or building fails
+            shared_ptr<ShaderProgram> GLGetProgram(
+                    std::string const &vsh_name,
+                    std::string const &fsh_name,
+                    Defines const &defines=Defines());
+
+            // * Number of unique (by content) programs
+            uint GetProgramCount() const;
+
+            // * Cleans up and releases all programs
+            void GLCleanUp();
+
+        private:
+            bool preprocess(std::string const &name,
+                            std::vector<std::string> &list_included,
+                            std::string &output) const;
+
+            std::string const m_glsl_version;
+            std::string const m_log_prefix;
+
+            std::unordered_map<std::string,std::string> m_lkup_sources;
+
+            // programs by variant key, and by preprocessed
+            // sources for deduplication
+            std::unordered_map<std::string,shared_ptr<ShaderProgram>> m_lkup_programs_by_variant;
+            std::unordered_map<std::string,shared_ptr<ShaderProgram>> m_lkup_programs_by_content;
+        };
+    }
+}
+
+#endif // KS_GL_SHADER_LIBRARY_HPP
@@ -16,15 +16,287 @@
 
 // stl
 #include <algorithm>
+#include <cstring>
+#include <mutex>
 
 // ks
+#include <ks/gl/KsGLAttributeBindings.hpp>
 #include <ks/gl/KsGLImplementation.hpp>
+#include <ks/gl/KsGLProgramBinaryCache.hpp>
 #include <ks/gl/KsGLShaderProgram.hpp>
+#include <ks/gl/KsGLStats.hpp>
+
+// GL_KHR_parallel_shader_compile
+#ifndef GL_COMPLETION_STATUS_KHR
+#define GL_COMPLETION_STATUS_KHR 0x91B1
+#endif
 
 namespace ks
 {
     namespace gl
     {
+        namespace
+        {
+            // Interned uniform names; entries are never removed
+            // so the name pointers held by UniformHandles stay valid
+            std::mutex g_uniform_name_mutex;
+            std::unordered_map<std::string,u32> g_lkup_uniform_name_id;
+
+            // Size in bytes of a single element of a uniform
+            // of the given type, as passed to glUniform*
+            uint getUniformTypeSize(GLenum type)
+            {
+                switch(type) {
+                case GL_FLOAT:
+                case GL_INT:
+                case GL_BOOL:
+                case GL_SAMPLER_2D:
+                case GL_SAMPLER_CUBE:
+                    return 4;
+                case GL_FLOAT_VEC2:
+                case GL_INT_VEC2:
+                case GL_BOOL_VEC2:
+                    return 8;
+                case GL_FLOAT_VEC3:
+                case GL_INT_VEC3:
+                case GL_BOOL_VEC3:
+                    return 12;
+                case GL_FLOAT_VEC4:
+                case GL_INT_VEC4:
+                case GL_BOOL_VEC4:
+                case GL_FLOAT_MAT2:
+                    return 16;
+                case GL_FLOAT_MAT3:
+                    return 36;
+                case GL_FLOAT_MAT4:
+                    return 64;
+                default:
+                    // unknown types are never shadowed
+                    return 0;
+                }
+            }
+
+            void uploadUniform(GLint location,GLsizei count,GLint const * ia)
+            {
+                glUniform1iv(location,count,ia);
+            }
+
+            void uploadUniform(GLint location,GLsizei count,GLfloat const * fa)
+            {
+                glUniform1fv(location,count,fa);
+            }
+
+            void uploadUniform(GLint location,GLsizei count,glm::vec2 const * v2a)
+            {
+                glUniform2fv(location,count,glm::value_ptr(v2a[0]));
+            }
+
+            void uploadUniform(GLint location,GLsizei count,glm::vec3 const * v3a)
+            {
+                glUniform3fv(location,count,glm::value_ptr(v3a[0]));
+            }
+
+            void uploadUniform(GLint location,GLsizei count,glm::vec4 const * v4a)
+            {
+                glUniform4fv(location,count,glm::value_ptr(v4a[0]));
+            }
+
+            void uploadUniform(GLint location,GLsizei count,glm::mat4 const * m4a)
+            {
+                glUniformMatrix4fv(location,count,false,glm::value_ptr(m4a[0]));
+            }
+
+            void uploadUniform(GLint location,GLsizei count,glm::ivec2 const * iv2a)
+            {
+                glUniform2iv(location,count,glm::value_ptr(iv2a[0]));
+            }
+
+            void uploadUniform(GLint location,GLsizei count,glm::ivec3 const * iv3a)
+            {
+                glUniform3iv(location,count,glm::value_ptr(iv3a[0]));
+            }
+
+            void uploadUniform(GLint location,GLsizei count,glm::ivec4 const * iv4a)
+            {
+                glUniform4iv(location,count,glm::value_ptr(iv4a[0]));
+            }
+
+            void uploadUniform(GLint location,GLsizei count,glm::mat2 const * m2a)
+            {
+                glUniformMatrix2fv(location,count,false,glm::value_ptr(m2a[0]));
+            }
+
+            void uploadUniform(GLint location,GLsizei count,glm::mat3 const * m3a)
+            {
+                glUniformMatrix3fv(location,count,false,glm::value_ptr(m3a[0]));
+            }
+
+            void uploadUniform(GLint location,GLsizei count,Sampler const * samplera)
+            {
+                static_assert(sizeof(Sampler) == sizeof(GLint),
+                              "Sampler must be tightly packed");
+
+                glUniform1iv(location,count,&(samplera[0].tex_unit));
+            }
+
+            // Returns true if values of the given C++ type
+            // can be used to set a uniform of @type
+            bool isCompatibleType(GLenum type,GLint const *)
+            {
+                return (type == GL_INT || type == GL_BOOL ||
+                        type == GL_SAMPLER_2D || type == GL_SAMPLER_CUBE);
+            }
+
+            bool isCompatibleType(GLenum type,GLfloat const *)
+            {
+                return (type == GL_FLOAT || type == GL_BOOL);
+            }
+
+            bool isCompatibleType(GLenum type,glm::vec2 const *)
+            {
+                return (type == GL_FLOAT_VEC2 || type == GL_BOOL_VEC2);
+            }
+
+            bool isCompatibleType(GLenum type,glm::vec3 const *)
+            {
+                return (type == GL_FLOAT_VEC3 || type == GL_BOOL_VEC3);
+            }
+
+            bool isCompatibleType(GLenum type,glm::vec4 const *)
+            {
+                return (type == GL_FLOAT_VEC4 || type == GL_BOOL_VEC4);
+            }
+
+            bool isCompatibleType(GLenum type,glm::ivec2 const *)
+            {
+                return (type == GL_INT_VEC2 || type == GL_BOOL_VEC2);
+            }
+
+            bool isCompatibleType(GLenum type,glm::ivec3 const *)
+            {
+                return (type == GL_INT_VEC3 || type == GL_BOOL_VEC3);
+            }
+
+            bool isCompatibleType(GLenum type,glm::ivec4 const *)
+            {
+                return (type == GL_INT_VEC4 || type == GL_BOOL_VEC4);
+            }
+
+            bool isCompatibleType(GLenum type,glm::mat2 const *)
+            {
+                return (type == GL_FLOAT_MAT2);
+            }
+
+            bool isCompatibleType(GLenum type,glm::mat3 const *)
+            {
+                return (type == GL_FLOAT_MAT3);
+            }
+
+            bool isCompatibleType(GLenum type,glm::mat4 const *)
+            {
+                return (type == GL_FLOAT_MAT4);
+            }
+
+            bool isCompatibleType(GLenum type,Sampler const *)
+            {
+                return (type == GL_SAMPLER_2D || type == GL_SAMPLER_CUBE);
+            }
+
+            // bool values are uploaded as ints
+            GLint toGLType(bool b)
+            {
+                return b;
+            }
+
+            glm::ivec2 toGLType(glm::bvec2 const &bv2)
+            {
+                return glm::ivec2(bv2.x,bv2.y);
+            }
+
+            glm::ivec3 toGLType(glm::bvec3 const &bv3)
+            {
+                return glm::ivec3(bv3.x,bv3.y,bv3.z);
+            }
+
+            glm::ivec4 toGLType(glm::bvec4 const &bv4)
+            {
+                return glm::ivec4(bv4.x,bv4.y,bv4.z,bv4.w);
+            }
+
+            template<typename T>
+            auto toGLType(std::vector<T> const &list_values) ->
+                std::vector<decltype(toGLType(list_values[0]))>
+            {
+                std::vector<decltype(toGLType(list_values[0]))> list_gl_values;
+                list_gl_values.reserve(list_values.size());
+                for(uint i=0; i < list_values.size(); i++) {
+                    list_gl_values.push_back(toGLType(list_values[i]));
+                }
+                return list_gl_values;
+            }
+
+            template<typename T>
+            auto toGLType(T const * values,uint count) ->
+                std::vector<decltype(toGLType(values[0]))>
+            {
+                std::vector<decltype(toGLType(values[0]))> list_gl_values;
+                list_gl_values.reserve(count);
+                for(uint i=0; i < count; i++) {
+                    list_gl_values.push_back(toGLType(values[i]));
+                }
+                return list_gl_values;
+            }
+
+            // Uploads a single element of shadowed uniform data
+            // for a uniform of @type
+            void uploadShadowedUniform(GLenum type,GLint location,u8 const * data)
+            {
+                GLfloat const * fa = reinterpret_cast<GLfloat const*>(data);
+                GLint const * ia = reinterpret_cast<GLint const*>(data);
+
+                switch(type) {
+                case GL_FLOAT:        glUniform1fv(location,1,fa); break;
+                case GL_FLOAT_VEC2:   glUniform2fv(location,1,fa); break;
+                case GL_FLOAT_VEC3:   glUniform3fv(location,1,fa); break;
+                case GL_FLOAT_VEC4:   glUniform4fv(location,1,fa); break;
+                case GL_FLOAT_MAT2:   glUniformMatrix2fv(location,1,false,fa); break;
+                case GL_FLOAT_MAT3:   glUniformMatrix3fv(location,1,false,fa); break;
+                case GL_FLOAT_MAT4:   glUniformMatrix4fv(location,1,false,fa); break;
+                case GL_INT:
+                case GL_SAMPLER_2D:
+                case GL_SAMPLER_CUBE: glUniform1iv(location,1,ia); break;
+                case GL_INT_VEC2:     glUniform2iv(location,1,ia); break;
+                case GL_INT_VEC3:     glUniform3iv(location,1,ia); break;
+                case GL_INT_VEC4:     glUniform4iv(location,1,ia); break;
+                default:
+                    break;
+                }
+            }
+
+            // bool uniforms may have been set with either int
+            // or float values, so their shadow can't be re-uploaded
+            bool isShadowCopyable(GLenum type)
+            {
+                return !(type == GL_BOOL || type == GL_BOOL_VEC2 ||
+                         type == GL_BOOL_VEC3 || type == GL_BOOL_VEC4);
+            }
+        }
+
+        // ============================================================= //
+
+        UniformHandle::UniformHandle(std::string const &name)
+        {
+            std::lock_guard<std::mutex> lock(g_uniform_name_mutex);
+
+            auto it = g_lkup_uniform_name_id.emplace(
+                        name,g_lkup_uniform_name_id.size()).first;
+
+            m_id = it->second;
+            m_name = &(it->first);
+        }
+
+        // ============================================================= //
+
         ShaderProgram::ShaderProgram(std::string source_vsh,
                                      std::string source_fsh,
                                      std::string glsl_version) :
@@ -35,6 +307,12 @@ namespace ks
             m_handle_vsh(0),
             m_handle_fsh(0),
             m_init(false),
+            m_status(Status::None),
+            m_parallel_compile(false),
+            m_use_binary_cache(false),
+            m_binary_cache_key(0),
+            m_generation(0),
+            m_attr_bindings_revision(0),
             m_impl_max_attrs(false)
         {
             m_log_prefix = "ShaderProgram: ";
@@ -69,14 +347,45 @@ namespace ks
 
         GLint ShaderProgram::GetUniformLocation(std::string const &name) const
         {
-            auto it = std::find_if(
-                        m_list_uniforms.begin(),
-                        m_list_uniforms.end(),
-                        [&name](UniformDesc const &uniform) -> bool {
-                            return(uniform.name == name);
-                        });
+            UniformDesc const * desc = findUniform(name);
+            return (desc) ? desc->location : -1;
+        }
+
+        GLint ShaderProgram::GetUniformLocation(UniformHandle const &handle) const
+        {
+            UniformDesc const * desc = findUniform(handle);
+            return (desc) ? desc->location : -1;
+        }
 
-            return (it != m_list_uniforms.end()) ? it->location : -1;
+        GLint ShaderProgram::GetUniformLocation(UniformHandle const &handle,
+                                                uint index) const
+        {
+            UniformDesc const * desc = findUniform(handle);
+            if(!desc || (index >= desc->elem_count)) {
+                return -1;
+            }
+            return m_list_elem_locations[desc->elem_index+index];
+        }
+
+        uint ShaderProgram::GetUniformArraySize(UniformHandle const &handle) const
+        {
+            UniformDesc const * desc = findUniform(handle);
+            return (desc) ? desc->elem_count : 0;
+        }
+
+        ShaderProgram::UniformStats const & ShaderProgram::GetUniformStats() const
+        {
+            return m_uniform_stats;
+        }
+
+        void ShaderProgram::ResetUniformStats()
+        {
+            m_uniform_stats = UniformStats();
+        }
+
+        void ShaderProgram::InvalidateUniforms()
+        {
+            m_list_shadow_valid.assign(m_list_shadow_valid.size(),false);
         }
 
         std::string const & ShaderProgram::GetDesc() const
@@ -118,7 +427,33 @@ namespace ks
 
         bool ShaderProgram::GLInit()
         {
-            if(m_init) {
+            if(!GLSubmit()) {
+                return false;
+            }
+            return GLFinish();
+        }
+
+        bool ShaderProgram::GLInitBatch(std::vector<ShaderProgram*> const &list_programs)
+        {
+            // Submit everything before querying any status so
+            // the driver can compile programs concurrently
+            bool ok = true;
+            for(auto program : list_programs) {
+                ok = program->GLSubmit() && ok;
+            }
+
+            for(auto program : list_programs) {
+                if(program->m_status == Status::Compiling) {
+                    ok = program->GLFinish() && ok;
+                }
+            }
+
+            return ok;
+        }
+
+        bool ShaderProgram::GLSubmit()
+        {
+            if(m_status != Status::None) {
                 LOG.Error() << m_log_prefix << "already init!";
                 return false;
             }
@@ -127,6 +462,136 @@ namespace ks
             // supported by this GL implementation
             m_impl_max_attrs = Implementation::GetMaxVertexAttribs();
 
+            m_parallel_compile =
+                    Implementation::GetGLExtensionExists(
+                        "GL_KHR_parallel_shader_compile") ||
+                    Implementation::GetGLExtensionExists(
+                        "GL_ARB_parallel_shader_compile");
+
+            // Try the program binary cache before
+            // compiling and linking from source
+            m_use_binary_cache = ProgramBinaryCache::IsEnabled();
+            if(m_use_binary_cache) {
+                // Read before the key so a concurrent change can
+                // only leave the revision older than the bindings
+                // the binary was linked with, never newer
+                u32 const revision = AttributeBindings::GetRevision();
+
+                m_binary_cache_key =
+                        ProgramBinaryCache::CalcKey(m_source_vsh,
+                                                    m_source_fsh,
+                                                    m_glsl_version,
+                                                    AttributeBindings::GetKey());
+
+                if(linkFromBinary(m_binary_cache_key)) {
+                    // The key includes the bindings, so the binary
+                    // was linked with the current ones
+                    m_attr_bindings_revision = revision;
+
+                    // Loading a binary doesn't need to wait
+                    // on the compiler
+                    m_use_binary_cache = false;
+                    m_status = Status::Compiling;
+                    return GLFinish();
+                }
+            }
+
+            if(!submitSource(m_use_binary_cache)) {
+                m_status = Status::Failed;
+                cleanUpHandles();
+                return false;
+            }
+
+            m_status = Status::Compiling;
+            return true;
+        }
+
+        bool ShaderProgram::GLFinish()
+        {
+            if(m_status != Status::Compiling) {
+                return (m_status == Status::Ready);
+            }
+
+            // Shaders are only present if the
+            // program was built from source
+            if(m_handle_vsh && m_handle_fsh) {
+                if(!finishSource()) {
+                    m_status = Status::Failed;
+                    cleanUpHandles();
+                    return false;
+                }
+
+                if(m_use_binary_cache) {
+                    ProgramBinaryCache::GLSave(m_handle_prog,m_binary_cache_key);
+                }
+            }
+
+            // get the list of attribute and uniform locations
+            // defined in the shader
+            if(!(this->getAttributes()) || !(this->getUniforms())) {
+                m_status = Status::Failed;
+                cleanUpHandles();
+                return false;
+            }
+
+            //
+            m_status = Status::Ready;
+            m_init = true;
+            return true;
+        }
+
+        bool ShaderProgram::IsReady()
+        {
+            if(m_status == Status::Compiling) {
+                // Without parallel compile support, checking the
+                // link status waits for the compiler anyway
+                if(m_parallel_compile) {
+                    GLint complete = GL_FALSE;
+                    glGetProgramiv(m_handle_prog,
+                                   GL_COMPLETION_STATUS_KHR,
+                                   &complete);
+                    KS_CHECK_GL_ERROR(m_log_prefix+"get completion status");
+
+                    if(complete == GL_FALSE) {
+                        return false;
+                    }
+                }
+                GLFinish();
+            }
+
+            return (m_status == Status::Ready);
+        }
+
+        ShaderProgram::Status ShaderProgram::GetStatus() const
+        {
+            return m_status;
+        }
+
+        bool ShaderProgram::linkFromBinary(u64 cache_key)
+        {
+            m_handle_prog = glCreateProgram();
+            if(m_handle_prog==0) {
+                LOG.Error() << m_log_prefix
+                           << "failed to create program";
+                return false;
+            }
+
+            if(!ProgramBinaryCache::GLLoad(m_handle_prog,cache_key)) {
+                glDeleteProgram(m_handle_prog);
+                KS_CHECK_GL_ERROR(m_log_prefix+"delete after failed binary load");
+                m_handle_prog = 0;
+                return false;
+            }
+
+            // no shader objects are created for binaries
+            m_handle_vsh = 0;
+            m_handle_fsh = 0;
+
+            return true;
+        }
+
+        bool ShaderProgram::submitSource(bool retrievable)
+        {
             // create vertex shader object
             m_handle_vsh = glCreateShader(GL_VERTEX_SHADER);
             if(m_handle_vsh == 0) {
@@ -137,9 +602,7 @@ namespace ks
                 return false;
             }
             // compile vertex shader
-            if(!loadShaderFromSource(m_source_vsh,m_handle_vsh)) {
-                return false;
-            }
+            loadShaderFromSource(m_source_vsh,m_handle_vsh);
 
             // create fragment shader object
             m_handle_fsh = glCreateShader(GL_FRAGMENT_SHADER);
@@ -151,9 +614,7 @@ namespace ks
                 return false;
             }
             // compile fragment shader
-            if(!loadShaderFromSource(m_source_fsh,m_handle_fsh)) {
-                return false;
-            }
+            loadShaderFromSource(m_source_fsh,m_handle_fsh);
 
             // create the shader program
             m_handle_prog = glCreateProgram();
@@ -170,10 +631,29 @@ namespace ks
             glAttachShader(m_handle_prog,m_handle_fsh);
             KS_CHECK_GL_ERROR(m_log_prefix+"attach frag shader");
 
-            // link
+            // bind any registered attribute locations
+            m_attr_bindings_revision = AttributeBindings::GLApply(m_handle_prog);
+
+            if(retrievable) {
+                ProgramBinaryCache::GLSetRetrievableHint(m_handle_prog);
+            }
+
+            // link; compile errors show up as a link failure
+            // and are checked for in finishSource
             glLinkProgram(m_handle_prog);
             KS_CHECK_GL_ERROR(m_log_prefix+"link");
 
+            return true;
+        }
+
+        bool ShaderProgram::finishSource()
+        {
+            // check compile status
+            if(!checkShaderCompiled(m_handle_vsh) ||
+               !checkShaderCompiled(m_handle_fsh)) {
+                return false;
+            }
+
             // check link status
             GLint link_status;
             glGetProgramiv(m_handle_prog,GL_LINK_STATUS,&link_status);
@@ -193,14 +673,6 @@ namespace ks
                 LOG.Error() << m_log_prefix
                            << "failed to link: " << err_msg;
 
-                glDeleteProgram(m_handle_prog);
-                KS_CHECK_GL_ERROR(m_log_prefix+"delete after failed link");
-                return false;
-            }
-
-            // get the list of attribute and uniform locations
-            // defined in the shader
-            if(!(this->getAttributes()) || !(this->getUniforms())) {
                 return false;
             }
 
@@ -237,15 +709,127 @@ namespace ks
                 m_handle_fsh=0;
             #endif
 
-            //
-            m_init = true;
             return true;
         }
 
+        void ShaderProgram::cleanUpHandles()
+        {
+            if(m_handle_vsh) {
+                glDeleteShader(m_handle_vsh);
+                m_handle_vsh = 0;
+            }
+            if(m_handle_fsh) {
+                glDeleteShader(m_handle_fsh);
+                m_handle_fsh = 0;
+            }
+            if(m_handle_prog) {
+                glDeleteProgram(m_handle_prog);
+                m_handle_prog = 0;
+            }
+            KS_CHECK_GL_ERROR(m_log_prefix+"clean up after failed init");
+        }
+
+        bool ShaderProgram::GLReload(StateSet* state_set,
+                                     std::string source_vsh,
+                                     std::string source_fsh)
+        {
+            if(m_status != Status::Ready) {
+                LOG.Error() << m_log_prefix << "reload: program not init";
+                return false;
+            }
+
+            // Build the replacement separately so a failed
+            // build leaves this program untouched
+            ShaderProgram program(std::move(source_vsh),
+                                  std::move(source_fsh),
+                                  m_glsl_version);
+            program.SetDesc(m_desc);
+
+            if(!program.GLInit()) {
+                LOG.Warn() << m_log_prefix
+                           << "reload failed, keeping current program";
+                return false;
+            }
+
+            program.copyUniformValues(state_set,*this);
+
+            // Swap the built program in; the temporary takes
+            // the current program and cleans it up
+            std::swap(m_source_vsh,program.m_source_vsh);
+            std::swap(m_source_fsh,program.m_source_fsh);
+            std::swap(m_handle_prog,program.m_handle_prog);
+            std::swap(m_handle_vsh,program.m_handle_vsh);
+            std::swap(m_handle_fsh,program.m_handle_fsh);
+            std::swap(m_impl_max_attrs,program.m_impl_max_attrs);
+            std::swap(m_list_attributes,program.m_list_attributes);
+            std::swap(m_list_uniforms,program.m_list_uniforms);
+            std::swap(m_list_elem_locations,program.m_list_elem_locations);
+            std::swap(m_lkup_uniform_by_name_id,program.m_lkup_uniform_by_name_id);
+            std::swap(m_shadow_data,program.m_shadow_data);
+            std::swap(m_list_shadow_valid,program.m_list_shadow_valid);
+            std::swap(m_list_attribs_used,program.m_list_attribs_used);
+            std::swap(m_attr_bindings_revision,program.m_attr_bindings_revision);
+
+            // If the old program is current, glDeleteProgram defers
+            // deleting it until another program is used
+            program.GLCleanUp();
+
+            m_generation++;
+            return true;
+        }
+
+        u32 ShaderProgram::GetGeneration() const
+        {
+            return m_generation;
+        }
+
+        u32 ShaderProgram::GetAttributeBindingsRevision() const
+        {
+            return m_attr_bindings_revision;
+        }
+
+        void ShaderProgram::copyUniformValues(StateSet* state_set,
+                                              ShaderProgram const &other)
+        {
+            // glUniform applies to the current program
+            auto const prev_prog = state_set->GetCurrentProgram();
+            state_set->SetProgram(m_handle_prog);
+
+            // Every element of an array has its own entry ("name[i]"),
+            // so only the first element of each entry is copied
+            for(auto const &desc : m_list_uniforms) {
+                UniformDesc const * other_desc =
+                        other.findUniformByNameId(desc.name_id);
+
+                if(!other_desc ||
+                   (other_desc->type != desc.type) ||
+                   (desc.elem_size == 0) ||
+                   !isShadowCopyable(desc.type) ||
+                   !other.m_list_shadow_valid[other_desc->elem_index]) {
+                    continue;
+                }
+
+                u8 const * data = &(other.m_shadow_data[other_desc->shadow_offset]);
+                std::memcpy(&(m_shadow_data[desc.shadow_offset]),data,desc.elem_size);
+                m_list_shadow_valid[desc.elem_index] = true;
+
+                uploadShadowedUniform(desc.type,desc.location,data);
+            }
+
+            KS_CHECK_GL_ERROR(m_log_prefix+"copy uniform values");
+
+            // If the program being replaced was current, this one
+            // is left current instead so the old one can be freed
+            if(prev_prog.valid &&
+               (prev_prog.value != static_cast<GLint>(other.m_handle_prog))) {
+                state_set->SetProgram(prev_prog.value);
+            }
+        }
+
         void ShaderProgram::GLEnable(StateSet * state_set)
         {
-            glUseProgram(m_handle_prog);
-            KS_CHECK_GL_ERROR(m_log_prefix+"enable");
+            // glUseProgram is skipped if this program is current
+            state_set->SetProgram(m_handle_prog);
 
             // enable associated vertex attribute arrays
             // and update the state set accordingly
@@ -254,7 +838,7 @@ namespace ks
             }
         }
 
-        void ShaderProgram::GLDisable()
+        void ShaderProgram::GLDisable(StateSet * state_set)
         {
             // Might not be a good idea to call this unnecessarily;
             // ref: http://stackoverflow.com/questions/13546461/what-does-gluseprogram0-do
@@ -262,8 +846,7 @@ namespace ks
             LOG.Warn() << m_log_prefix << "called disable";
             #endif
 
-            glUseProgram(0);
-            KS_CHECK_GL_ERROR(m_log_prefix+"disable");
+            state_set->SetProgram(0);
         }
 
         void ShaderProgram::GLCleanUp()
@@ -283,88 +866,517 @@ namespace ks
             KS_CHECK_GL_ERROR(m_log_prefix+"delete shader prog");
 
             m_init = false;
+            m_status = Status::None;
         }
 
         // ============================================================= //
 
         void ShaderProgram::GLSetUniform(std::string const &name,GLint i)
         {
-            glUniform1iv(GetUniformLocation(name),1,&i);
-            KS_CHECK_GL_ERROR(m_log_prefix+"set uniform1iv "+name);
+            setUniform(findUniform(name),0,&i,1);
         }
 
         void ShaderProgram::GLSetUniform(std::string const &name,GLfloat f)
         {
-            glUniform1fv(GetUniformLocation(name),1,&f);
-//            glUniform1f(GetUniformLocation(name),f);
-            KS_CHECK_GL_ERROR(m_log_prefix+"set uniform1fv "+name);
+            setUniform(findUniform(name),0,&f,1);
         }
 
         void ShaderProgram::GLSetUniform(std::string const &name,glm::vec2 const &v2)
         {
-            glUniform2fv(GetUniformLocation(name),1,glm::value_ptr(v2));
-            KS_CHECK_GL_ERROR(m_log_prefix+"set uniform2fv "+name);
+            setUniform(findUniform(name),0,&v2,1);
         }
 
         void ShaderProgram::GLSetUniform(std::string const &name,glm::vec3 const &v3)
         {
-            glUniform3fv(GetUniformLocation(name),1,glm::value_ptr(v3));
-            KS_CHECK_GL_ERROR(m_log_prefix+"set uniform3fv "+name);
+            setUniform(findUniform(name),0,&v3,1);
         }
 
         void ShaderProgram::GLSetUniform(std::string const &name,glm::vec4 const &v4)
         {
-            glUniform4fv(GetUniformLocation(name),1,glm::value_ptr(v4));
-            KS_CHECK_GL_ERROR(m_log_prefix+"set uniform4fv "+name);
+            setUniform(findUniform(name),0,&v4,1);
         }
 
         void ShaderProgram::GLSetUniform(std::string const &name,glm::mat4 const &m4)
         {
-            glUniformMatrix4fv(GetUniformLocation(name),1,false,glm::value_ptr(m4));
-            KS_CHECK_GL_ERROR(m_log_prefix+"set uniform mat4fv "+name);
+            setUniform(findUniform(name),0,&m4,1);
         }
 
-
-
         void ShaderProgram::GLSetUniform(std::string const &name,std::vector<GLint> const &ia)
         {
-            glUniform1iv(GetUniformLocation(name),ia.size(),&(ia[0]));
-            KS_CHECK_GL_ERROR(m_log_prefix+"set uniform1iv array "+name);
+            setUniform(findUniform(name),0,ia.data(),ia.size());
         }
 
         void ShaderProgram::GLSetUniform(std::string const &name,std::vector<GLfloat> const &fa)
         {
-            glUniform1fv(GetUniformLocation(name),fa.size(),&(fa[0]));
-            KS_CHECK_GL_ERROR(m_log_prefix+"set uniform1fv array "+name);
+            setUniform(findUniform(name),0,fa.data(),fa.size());
         }
 
         void ShaderProgram::GLSetUniform(std::string const &name,std::vector<glm::vec2> const &v2a)
         {
-            glUniform2fv(GetUniformLocation(name),v2a.size(),glm::value_ptr(v2a[0]));
-            KS_CHECK_GL_ERROR(m_log_prefix+"set uniform2fv array "+name);
+            setUniform(findUniform(name),0,v2a.data(),v2a.size());
         }
 
         void ShaderProgram::GLSetUniform(std::string const &name,std::vector<glm::vec3> const &v3a)
         {
-            glUniform3fv(GetUniformLocation(name),v3a.size(),glm::value_ptr(v3a[0]));
-            KS_CHECK_GL_ERROR(m_log_prefix+"set uniform3fv array "+name);
+            setUniform(findUniform(name),0,v3a.data(),v3a.size());
         }
 
         void ShaderProgram::GLSetUniform(std::string const &name,std::vector<glm::vec4> const &v4a)
         {
-            glUniform4fv(GetUniformLocation(name),v4a.size(),glm::value_ptr(v4a[0]));
-            KS_CHECK_GL_ERROR(m_log_prefix+"set uniform4fv array "+name);
+            setUniform(findUniform(name),0,v4a.data(),v4a.size());
         }
 
         void ShaderProgram::GLSetUniform(std::string const &name,std::vector<glm::mat4> const &m4a)
         {
-            glUniformMatrix4fv(GetUniformLocation(name),m4a.size(),false,glm::value_ptr(m4a[0]));
-            KS_CHECK_GL_ERROR(m_log_prefix+"set uniform mat4fv array"+name);
+            setUniform(findUniform(name),0,m4a.data(),m4a.size());
+        }
+
+        void ShaderProgram::GLSetUniform(UniformHandle const &handle,GLint i)
+        {
+            setUniform(findUniform(handle),0,&i,1);
+        }
+
+        void ShaderProgram::GLSetUniform(UniformHandle const &handle,GLfloat f)
+        {
+            setUniform(findUniform(handle),0,&f,1);
+        }
+
+        void ShaderProgram::GLSetUniform(UniformHandle const &handle,glm::vec2 const &v2)
+        {
+            setUniform(findUniform(handle),0,&v2,1);
+        }
+
+        void ShaderProgram::GLSetUniform(UniformHandle const &handle,glm::vec3 const &v3)
+        {
+            setUniform(findUniform(handle),0,&v3,1);
+        }
+
+        void ShaderProgram::GLSetUniform(UniformHandle const &handle,glm::vec4 const &v4)
+        {
+            setUniform(findUniform(handle),0,&v4,1);
+        }
+
+        void ShaderProgram::GLSetUniform(UniformHandle const &handle,glm::mat4 const &m4)
+        {
+            setUniform(findUniform(handle),0,&m4,1);
+        }
+
+        void ShaderProgram::GLSetUniform(UniformHandle const &handle,std::vector<GLint> const &ia)
+        {
+            setUniform(findUniform(handle),0,ia.data(),ia.size());
+        }
+
+        void ShaderProgram::GLSetUniform(UniformHandle const &handle,std::vector<GLfloat> const &fa)
+        {
+            setUniform(findUniform(handle),0,fa.data(),fa.size());
+        }
+
+        void ShaderProgram::GLSetUniform(UniformHandle const &handle,std::vector<glm::vec2> const &v2a)
+        {
+            setUniform(findUniform(handle),0,v2a.data(),v2a.size());
+        }
+
+        void ShaderProgram::GLSetUniform(UniformHandle const &handle,std::vector<glm::vec3> const &v3a)
+        {
+            setUniform(findUniform(handle),0,v3a.data(),v3a.size());
+        }
+
+        void ShaderProgram::GLSetUniform(UniformHandle const &handle,std::vector<glm::vec4> const &v4a)
+        {
+            setUniform(findUniform(handle),0,v4a.data(),v4a.size());
+        }
+
+        void ShaderProgram::GLSetUniform(UniformHandle const &handle,std::vector<glm::mat4> const &m4a)
+        {
+            setUniform(findUniform(handle),0,m4a.data(),m4a.size());
+        }
+
+        void ShaderProgram::GLSetUniform(UniformHandle const &handle,uint index,GLint const * ia,uint count)
+        {
+            setUniform(findUniform(handle),index,ia,count);
+        }
+
+        void ShaderProgram::GLSetUniform(UniformHandle const &handle,uint index,GLfloat const * fa,uint count)
+        {
+            setUniform(findUniform(handle),index,fa,count);
+        }
+
+        void ShaderProgram::GLSetUniform(UniformHandle const &handle,uint index,glm::vec2 const * v2a,uint count)
+        {
+            setUniform(findUniform(handle),index,v2a,count);
+        }
+
+        void ShaderProgram::GLSetUniform(UniformHandle const &handle,uint index,glm::vec3 const * v3a,uint count)
+        {
+            setUniform(findUniform(handle),index,v3a,count);
+        }
+
+        void ShaderProgram::GLSetUniform(UniformHandle const &handle,uint index,glm::vec4 const * v4a,uint count)
+        {
+            setUniform(findUniform(handle),index,v4a,count);
+        }
+
+        void ShaderProgram::GLSetUniform(UniformHandle const &handle,uint index,glm::mat4 const * m4a,uint count)
+        {
+            setUniform(findUniform(handle),index,m4a,count);
+        }
+
+        void ShaderProgram::GLSetUniform(std::string const &name,glm::ivec2 const &iv2)
+        {
+            setUniform(findUniform(name),0,&iv2,1);
+        }
+
+        void ShaderProgram::GLSetUniform(std::string const &name,glm::ivec3 const &iv3)
+        {
+            setUniform(findUniform(name),0,&iv3,1);
+        }
+
+        void ShaderProgram::GLSetUniform(std::string const &name,glm::ivec4 const &iv4)
+        {
+            setUniform(findUniform(name),0,&iv4,1);
+        }
+
+        void ShaderProgram::GLSetUniform(std::string const &name,glm::mat2 const &m2)
+        {
+            setUniform(findUniform(name),0,&m2,1);
+        }
+
+        void ShaderProgram::GLSetUniform(std::string const &name,glm::mat3 const &m3)
+        {
+            setUniform(findUniform(name),0,&m3,1);
+        }
+
+        void ShaderProgram::GLSetUniform(std::string const &name,Sampler const &sampler)
+        {
+            setUniform(findUniform(name),0,&sampler,1);
+        }
+
+        void ShaderProgram::GLSetUniform(std::string const &name,bool b)
+        {
+            auto const gl_b = toGLType(b);
+            setUniform(findUniform(name),0,&gl_b,1);
+        }
+
+        void ShaderProgram::GLSetUniform(std::string const &name,glm::bvec2 const &bv2)
+        {
+            auto const gl_bv2 = toGLType(bv2);
+            setUniform(findUniform(name),0,&gl_bv2,1);
+        }
+
+        void ShaderProgram::GLSetUniform(std::string const &name,glm::bvec3 const &bv3)
+        {
+            auto const gl_bv3 = toGLType(bv3);
+            setUniform(findUniform(name),0,&gl_bv3,1);
+        }
+
+        void ShaderProgram::GLSetUniform(std::string const &name,glm::bvec4 const &bv4)
+        {
+            auto const gl_bv4 = toGLType(bv4);
+            setUniform(findUniform(name),0,&gl_bv4,1);
+        }
+
+        void ShaderProgram::GLSetUniform(std::string const &name,std::vector<glm::ivec2> const &iv2a)
+        {
+            setUniform(findUniform(name),0,iv2a.data(),iv2a.size());
+        }
+
+        void ShaderProgram::GLSetUniform(std::string const &name,std::vector<glm::ivec3> const &iv3a)
+        {
+            setUniform(findUniform(name),0,iv3a.data(),iv3a.size());
+        }
+
+        void ShaderProgram::GLSetUniform(std::string const &name,std::vector<glm::ivec4> const &iv4a)
+        {
+            setUniform(findUniform(name),0,iv4a.data(),iv4a.size());
+        }
+
+        void ShaderProgram::GLSetUniform(std::string const &name,std::vector<glm::mat2> const &m2a)
+        {
+            setUniform(findUniform(name),0,m2a.data(),m2a.size());
+        }
+
+        void ShaderProgram::GLSetUniform(std::string const &name,std::vector<glm::mat3> const &m3a)
+        {
+            setUniform(findUniform(name),0,m3a.data(),m3a.size());
+        }
+
+        void ShaderProgram::GLSetUniform(std::string const &name,std::vector<Sampler> const &samplera)
+        {
+            setUniform(findUniform(name),0,samplera.data(),samplera.size());
+        }
+
+        void ShaderProgram::GLSetUniform(std::string const &name,std::vector<bool> const &ba)
+        {
+            auto const gl_ba = toGLType(ba);
+            setUniform(findUniform(name),0,gl_ba.data(),gl_ba.size());
+        }
+
+        void ShaderProgram::GLSetUniform(std::string const &name,std::vector<glm::bvec2> const &bv2a)
+        {
+            auto const gl_bv2a = toGLType(bv2a);
+            setUniform(findUniform(name),0,gl_bv2a.data(),gl_bv2a.size());
+        }
+
+        void ShaderProgram::GLSetUniform(std::string const &name,std::vector<glm::bvec3> const &bv3a)
+        {
+            auto const gl_bv3a = toGLType(bv3a);
+            setUniform(findUniform(name),0,gl_bv3a.data(),gl_bv3a.size());
+        }
+
+        void ShaderProgram::GLSetUniform(std::string const &name,std::vector<glm::bvec4> const &bv4a)
+        {
+            auto const gl_bv4a = toGLType(bv4a);
+            setUniform(findUniform(name),0,gl_bv4a.data(),gl_bv4a.size());
+        }
+
+        void ShaderProgram::GLSetUniform(UniformHandle const &handle,glm::ivec2 const &iv2)
+        {
+            setUniform(findUniform(handle),0,&iv2,1);
+        }
+
+        void ShaderProgram::GLSetUniform(UniformHandle const &handle,glm::ivec3 const &iv3)
+        {
+            setUniform(findUniform(handle),0,&iv3,1);
+        }
+
+        void ShaderProgram::GLSetUniform(UniformHandle const &handle,glm::ivec4 const &iv4)
+        {
+            setUniform(findUniform(handle),0,&iv4,1);
+        }
+
+        void ShaderProgram::GLSetUniform(UniformHandle const &handle,glm::mat2 const &m2)
+        {
+            setUniform(findUniform(handle),0,&m2,1);
+        }
+
+        void ShaderProgram::GLSetUniform(UniformHandle const &handle,glm::mat3 const &m3)
+        {
+            setUniform(findUniform(handle),0,&m3,1);
+        }
+
+        void ShaderProgram::GLSetUniform(UniformHandle const &handle,Sampler const &sampler)
+        {
+            setUniform(findUniform(handle),0,&sampler,1);
+        }
+
+        void ShaderProgram::GLSetUniform(UniformHandle const &handle,bool b)
+        {
+            auto const gl_b = toGLType(b);
+            setUniform(findUniform(handle),0,&gl_b,1);
+        }
+
+        void ShaderProgram::GLSetUniform(UniformHandle const &handle,glm::bvec2 const &bv2)
+        {
+            auto const gl_bv2 = toGLType(bv2);
+            setUniform(findUniform(handle),0,&gl_bv2,1);
+        }
+
+        void ShaderProgram::GLSetUniform(UniformHandle const &handle,glm::bvec3 const &bv3)
+        {
+            auto const gl_bv3 = toGLType(bv3);
+            setUniform(findUniform(handle),0,&gl_bv3,1);
+        }
+
+        void ShaderProgram::GLSetUniform(UniformHandle const &handle,glm::bvec4 const &bv4)
+        {
+            auto const gl_bv4 = toGLType(bv4);
+            setUniform(findUniform(handle),0,&gl_bv4,1);
+        }
+
+        void ShaderProgram::GLSetUniform(UniformHandle const &handle,std::vector<glm::ivec2> const &iv2a)
+        {
+            setUniform(findUniform(handle),0,iv2a.data(),iv2a.size());
+        }
+
+        void ShaderProgram::GLSetUniform(UniformHandle const &handle,std::vector<glm::ivec3> const &iv3a)
+        {
+            setUniform(findUniform(handle),0,iv3a.data(),iv3a.size());
+        }
+
+        void ShaderProgram::GLSetUniform(UniformHandle const &handle,std::vector<glm::ivec4> const &iv4a)
+        {
+            setUniform(findUniform(handle),0,iv4a.data(),iv4a.size());
+        }
+
+        void ShaderProgram::GLSetUniform(UniformHandle const &handle,std::vector<glm::mat2> const &m2a)
+        {
+            setUniform(findUniform(handle),0,m2a.data(),m2a.size());
+        }
+
+        void ShaderProgram::GLSetUniform(UniformHandle const &handle,std::vector<glm::mat3> const &m3a)
+        {
+            setUniform(findUniform(handle),0,m3a.data(),m3a.size());
+        }
+
+        void ShaderProgram::GLSetUniform(UniformHandle const &handle,std::vector<Sampler> const &samplera)
+        {
+            setUniform(findUniform(handle),0,samplera.data(),samplera.size());
+        }
+
+        void ShaderProgram::GLSetUniform(UniformHandle const &handle,std::vector<bool> const &ba)
+        {
+            auto const gl_ba = toGLType(ba);
+            setUniform(findUniform(handle),0,gl_ba.data(),gl_ba.size());
+        }
+
+        void ShaderProgram::GLSetUniform(UniformHandle const &handle,std::vector<glm::bvec2> const &bv2a)
+        {
+            auto const gl_bv2a = toGLType(bv2a);
+            setUniform(findUniform(handle),0,gl_bv2a.data(),gl_bv2a.size());
+        }
+
+        void ShaderProgram::GLSetUniform(UniformHandle const &handle,std::vector<glm::bvec3> const &bv3a)
+        {
+            auto const gl_bv3a = toGLType(bv3a);
+            setUniform(findUniform(handle),0,gl_bv3a.data(),gl_bv3a.size());
+        }
+
+        void ShaderProgram::GLSetUniform(UniformHandle const &handle,std::vector<glm::bvec4> const &bv4a)
+        {
+            auto const gl_bv4a = toGLType(bv4a);
+            setUniform(findUniform(handle),0,gl_bv4a.data(),gl_bv4a.size());
+        }
+
+        void ShaderProgram::GLSetUniform(UniformHandle const &handle,uint index,glm::ivec2 const * iv2a,uint count)
+        {
+            setUniform(findUniform(handle),index,iv2a,count);
+        }
+
+        void ShaderProgram::GLSetUniform(UniformHandle const &handle,uint index,glm::ivec3 const * iv3a,uint count)
+        {
+            setUniform(findUniform(handle),index,iv3a,count);
+        }
+
+        void ShaderProgram::GLSetUniform(UniformHandle const &handle,uint index,glm::ivec4 const * iv4a,uint count)
+        {
+            setUniform(findUniform(handle),index,iv4a,count);
+        }
+
+        void ShaderProgram::GLSetUniform(UniformHandle const &handle,uint index,glm::mat2 const * m2a,uint count)
+        {
+            setUniform(findUniform(handle),index,m2a,count);
+        }
+
+        void ShaderProgram::GLSetUniform(UniformHandle const &handle,uint index,glm::mat3 const * m3a,uint count)
+        {
+            setUniform(findUniform(handle),index,m3a,count);
+        }
+
+        void ShaderProgram::GLSetUniform(UniformHandle const &handle,uint index,Sampler const * samplera,uint count)
+        {
+            setUniform(findUniform(handle),index,samplera,count);
+        }
+
+        void ShaderProgram::GLSetUniform(UniformHandle const &handle,uint index,bool const * ba,uint count)
+        {
+            auto const gl_ba = toGLType(ba,count);
+            setUniform(findUniform(handle),index,gl_ba.data(),count);
+        }
+
+        void ShaderProgram::GLSetUniform(UniformHandle const &handle,uint index,glm::bvec2 const * bv2a,uint count)
+        {
+            auto const gl_bv2a = toGLType(bv2a,count);
+            setUniform(findUniform(handle),index,gl_bv2a.data(),count);
+        }
+
+        void ShaderProgram::GLSetUniform(UniformHandle const &handle,uint index,glm::bvec3 const * bv3a,uint count)
+        {
+            auto const gl_bv3a = toGLType(bv3a,count);
+            setUniform(findUniform(handle),index,gl_bv3a.data(),count);
+        }
+
+        void ShaderProgram::GLSetUniform(UniformHandle const &handle,uint index,glm::bvec4 const * bv4a,uint count)
+        {
+            auto const gl_bv4a = toGLType(bv4a,count);
+            setUniform(findUniform(handle),index,gl_bv4a.data(),count);
         }
 
         // ============================================================= //
 
-        bool ShaderProgram::loadShaderFromSource(std::string const &shader_source,
+        template<typename T>
+        void ShaderProgram::setUniform(UniformDesc const * desc,
+                                       uint index,
+                                       T const * data,
+                                       uint count)
+        {
+            // Writes past the end of a uniform array are
+            // ignored by GL so they're ignored here too
+            if(!desc || (index >= desc->elem_count) || (count == 0)) {
+                return;
+            }
+            count = std::min(count,desc->elem_count-index);
+
+            #ifdef KS_DEBUG_GL
+            if(!isCompatibleType(desc->type,data)) {
+                LOG.Error() << m_log_prefix << "value type doesn't match "
+                               "type of uniform: " << desc->name;
+                return;
+            }
+            #endif
+
+            uint const first_elem = desc->elem_index+index;
+            uint const elem_size = sizeof(T);
+
+            if(elem_size != desc->elem_size) {
+                // The data doesn't match the uniform's type (which
+                // is a GL error) or its size is unknown; don't keep
+                // a copy we can't trust
+                for(uint i=0; i < count; i++) {
+                    m_list_shadow_valid[first_elem+i] = false;
+                }
+                uploadUniform(m_list_elem_locations[first_elem],count,data);
+                KS_CHECK_GL_ERROR(m_log_prefix,"set uniform ",desc->name);
+                KS_GL_STATS_ISSUED(Uniform);
+                m_uniform_stats.uploaded++;
+                return;
+            }
+
+            u8 * shadow =
+                    &(m_shadow_data[desc->shadow_offset+(index*elem_size)]);
+
+            bool uploaded = false;
+            uint i=0;
+            while(i < count) {
+                // Skip elements that match the shadow copy
+                while((i < count) &&
+                      m_list_shadow_valid[first_elem+i] &&
+                      (memcmp(shadow+(i*elem_size),&(data[i]),elem_size) == 0)) {
+                    i++;
+                }
+
+                if(i == count) {
+                    break;
+                }
+
+                // Find the run of elements that don't
+                uint const run_start = i;
+                while((i < count) &&
+                      !(m_list_shadow_valid[first_elem+i] &&
+                        (memcmp(shadow+(i*elem_size),&(data[i]),elem_size) == 0))) {
+                    memcpy(shadow+(i*elem_size),&(data[i]),elem_size);
+                    m_list_shadow_valid[first_elem+i] = true;
+                    i++;
+                }
+
+                uploadUniform(m_list_elem_locations[first_elem+run_start],
+                              i-run_start,
+                              &(data[run_start]));
+
+                KS_CHECK_GL_ERROR(m_log_prefix,"set uniform ",desc->name);
+                KS_GL_STATS_ISSUED(Uniform);
+                m_uniform_stats.uploaded++;
+                uploaded = true;
+            }
+
+            if(!uploaded) {
+                KS_GL_STATS_FILTERED(Uniform);
+                m_uniform_stats.skipped++;
+            }
+        }
+
+        // ============================================================= //
+
+        void ShaderProgram::loadShaderFromSource(std::string const &shader_source,
                                                  GLuint const shader_handle)
         {
             // add version to source
@@ -379,7 +1391,10 @@ namespace ks
             // compile
             glCompileShader(shader_handle);
             KS_CHECK_GL_ERROR(m_log_prefix+"compile glsl");
+        }
 
+        bool ShaderProgram::checkShaderCompiled(GLuint const shader_handle)
+        {
             // check compile status
             GLint compile_status;
             glGetShaderiv(shader_handle,GL_COMPILE_STATUS,&compile_status);
@@ -412,9 +1427,6 @@ namespace ks
                           << "Failed to compile glsl: LOG: \n" << err_msg;
 
                 assert(compile_status != GL_FALSE);
-
-                glDeleteShader(shader_handle);
-                KS_CHECK_GL_ERROR(m_log_prefix+"delete after failed load");
                 return false;
             }
 
@@ -482,6 +1494,36 @@ namespace ks
             return true;
         }
 
+        ShaderProgram::UniformDesc const *
+        ShaderProgram::findUniform(std::string const &name) const
+        {
+            auto it = std::find_if(
+                        m_list_uniforms.begin(),
+                        m_list_uniforms.end(),
+                        [&name](UniformDesc const &uniform) -> bool {
+                            return(uniform.name == name);
+                        });
+
+            return (it != m_list_uniforms.end()) ? &(*it) : nullptr;
+        }
+
+        ShaderProgram::UniformDesc const *
+        ShaderProgram::findUniform(UniformHandle const &handle) const
+        {
+            return findUniformByNameId(handle.GetId());
+        }
+
+        ShaderProgram::UniformDesc const *
+        ShaderProgram::findUniformByNameId(u32 name_id) const
+        {
+            if(name_id >= m_lkup_uniform_by_name_id.size()) {
+                return nullptr;
+            }
+
+            sint const index = m_lkup_uniform_by_name_id[name_id];
+            return (index < 0) ? nullptr : &(m_list_uniforms[index]);
+        }
+
         bool ShaderProgram::getUniforms()
         {
             // get the number of active uniforms
@@ -496,6 +1538,13 @@ namespace ks
                            GL_ACTIVE_UNIFORM_MAX_LENGTH,
                            &max_unif_length);
 
+            m_list_uniforms.clear();
+            m_list_elem_locations.clear();
+
+            // element and shadow data layout
+            uint elem_index = 0;
+            uint shadow_offset = 0;
+
             // get uniform location, name and type
             for(GLint i=0; i < unif_count; i++) {
                 GLsizei unif_length;
@@ -528,8 +1577,15 @@ namespace ks
                         return false;
                     }
 
+                    uint const elem_size = getUniformTypeSize(unif_type);
+
                     m_list_uniforms.push_back(
-                        {name,uniform_loc,unif_type});
+                        {name,uniform_loc,unif_type,0,
+                         elem_size,1,elem_index,shadow_offset});
+
+                    m_list_elem_locations.push_back(uniform_loc);
+                    shadow_offset += elem_size;
+                    elem_index += 1;
                 }
                 else {
                     // If this uniform is an array, save all of its
@@ -557,13 +1613,18 @@ namespace ks
                     std::string name_full;
                     std::string name_base;
 
-                    size_t const arr_op_idx = name.find("[0]",0);
-                    if(arr_op_idx == std::string::npos) {
+                    // Only a trailing "[0]" belongs to this array;
+                    // ie. "lights[0].w[0]" has the base "lights[0].w"
+                    bool const has_arr_op =
+                            (name.size() >= 3) &&
+                            (name.compare(name.size()-3,3,"[0]") == 0);
+
+                    if(!has_arr_op) {
                         name_base = name;
                         name_full = name_base + "[0]";
                     }
                     else {
-                        name_base = name.substr(0,arr_op_idx);
+                        name_base = name.substr(0,name.size()-3);
                         name_full = name;
                     }
 
@@ -586,13 +1647,20 @@ namespace ks
                     }
 
                     // save the first location under both names
-                    // for convenience
+                    // for convenience; both refer to the shadow
+                    // data for the entire array
+                    uint const elem_size = getUniformTypeSize(unif_type);
+                    uint const elem_count = unif_sz;
                     {
                         m_list_uniforms.push_back(
-                            {name_full,first_loc,unif_type});
+                            {name_full,first_loc,unif_type,0,
+                             elem_size,elem_count,elem_index,shadow_offset});
 
                         m_list_uniforms.push_back(
-                            {name_base,first_loc,unif_type});
+                            {name_base,first_loc,unif_type,0,
+                             elem_size,elem_count,elem_index,shadow_offset});
+
+                        m_list_elem_locations.push_back(first_loc);
                     }
 
                     // save the rest of the indices
@@ -610,13 +1678,39 @@ namespace ks
                             return false;
                         }
 
+                        // setting the uniform by an index name
+                        // can write through to the end of the array
                         m_list_uniforms.push_back(
-                            {name_index,uniform_loc,unif_type});
+                            {name_index,uniform_loc,unif_type,0,
+                             elem_size,elem_count-n,elem_index+n,
+                             shadow_offset+(elem_size*n)});
+
+                        m_list_elem_locations.push_back(uniform_loc);
                     }
+
+                    shadow_offset += elem_size*elem_count;
+                    elem_index += elem_count;
                 }
             }
             KS_CHECK_GL_ERROR(m_log_prefix+"get uniforms");
 
+            // Build the handle lookup table
+            m_lkup_uniform_by_name_id.clear();
+            for(uint i=0; i < m_list_uniforms.size(); i++) {
+                UniformDesc &desc = m_list_uniforms[i];
+                desc.name_id = UniformHandle(desc.name).GetId();
+
+                if(desc.name_id >= m_lkup_uniform_by_name_id.size()) {
+                    m_lkup_uniform_by_name_id.resize(desc.name_id+1,-1);
+                }
+                m_lkup_uniform_by_name_id[desc.name_id] = i;
+            }
+
+            // Nothing is known about the uniform values
+            // until they're first set
+            m_shadow_data.assign(shadow_offset,0);
+            m_list_shadow_valid.assign(elem_index,false);
+
             return true;
         }
     } // gl
@@ -26,6 +26,8 @@
 #include <glm/vec2.hpp>
 #include <glm/vec3.hpp>
 #include <glm/vec4.hpp>
+#include <glm/mat2x2.hpp>
+#include <glm/mat3x3.hpp>
 #include <glm/mat4x4.hpp>
 #include <glm/gtc/type_ptr.hpp>
 
@@ -39,6 +41,45 @@ namespace ks
 {
     namespace gl
     {
+        // ============================================================= //
+
+        // * Identifies a uniform by name independent of any
+        //   particular ShaderProgram
+        // * The name is interned once on construction so setting
+        //   a uniform with a handle is an index lookup instead
+        //   of a string comparison over all of a program's uniforms
+        // * Create handles up front (ie. as members or statics),
+        //   not per draw call
+        class UniformHandle
+        {
+        public:
+            explicit UniformHandle(std::string const &name);
+
+            u32 GetId() const
+            {
+                return m_id;
+            }
+
+            std::string const & GetName() const
+            {
+                return *m_name;
+            }
+
+        private:
+            u32 m_id;
+            std::string const * m_name;
+        };
+
+        // ============================================================= //
+
+        // * Value type for sampler uniforms; the texture
+        //   unit the sampler reads from
+        struct Sampler
+        {
+            GLint tex_unit;
+        };
+
+        // ============================================================= //
 
         class ShaderProgram : public Resource
         {
@@ -59,6 +100,36 @@ namespace ks
 
             GLint GetAttributeLocation(std::string const &name) const;
             GLint GetUniformLocation(std::string const &name) const;
+            GLint GetUniformLocation(UniformHandle const &handle) const;
+
+            // * Location of element @index of a uniform array; the
+            //   index is relative to the element @handle refers to
+            // * Returns -1 if @index is out of range
+            GLint GetUniformLocation(UniformHandle const &handle,
+                                     uint index) const;
+
+            // * Number of elements in a uniform array from the
+            //   element @handle refers to onwards; 1 for non
+            //   array uniforms and 0 if the uniform isn't active
+            uint GetUniformArraySize(UniformHandle const &handle) const;
+
+            // * ShaderProgram keeps a copy of the last value set for
+            //   each active uniform and skips uploads that wouldn't
+            //   change it
+            // * Assumes uniforms for this program are only ever
+            //   set through GLSetUniform; if glUniform is called
+            //   directly, call InvalidateUniforms afterwards
+            // * Partial array uploads count each contiguous run
+            //   of changed elements as one upload
+            struct UniformStats
+            {
+                u64 uploaded{0};
+                u64 skipped{0};
+            };
+
+            UniformStats const & GetUniformStats() const;
+            void ResetUniformStats();
+            void InvalidateUniforms();
 
             std::string const & GetDesc() const;
             GLuint GetHandle() const;
@@ -70,19 +141,85 @@ namespace ks
             void PrintAttributes() const;
             void PrintUniforms() const;
 
-            //
+            // * Compiles and links the program, waiting for
+            //   the result
             bool GLInit();
+
+            // * Compiles and links all of @list_programs; every
+            //   program is submitted before any is waited on so
+            //   the driver can build them concurrently
+            static bool GLInitBatch(std::vector<ShaderProgram*> const &list_programs);
+
+            // * GLSubmit starts compiling and linking the program
+            //   without waiting for the result. GLFinish waits for
+            //   the result and completes initialization
+            // * IsReady completes initialization if the program
+            //   has finished building, otherwise it returns false.
+            //   It only avoids waiting on the compiler if
+            //   GL_KHR_parallel_shader_compile is available
+            enum class Status : u8
+            {
+                None,
+                Compiling,
+                Ready,
+                Failed
+            };
+
+            bool GLSubmit();
+            bool GLFinish();
+            bool IsReady();
+            Status GetStatus() const;
+
+            // * Builds a new program from @source_vsh and @source_fsh
+            //   and swaps it in place of the current one, so anything
+            //   holding this ShaderProgram picks up the new program
+            // * If building fails the current program is kept and
+            //   false is returned
+            // * Uniform values set on the current program are set on
+            //   the new program where the uniform still exists with
+            //   the same type (bool uniforms are left unset)
+            // * Must be called between frames; programs are switched
+            //   through @state_set to copy uniform values and the
+            //   program that was current is restored afterwards
+            bool GLReload(StateSet* state_set,
+                          std::string source_vsh,
+                          std::string source_fsh);
+
+            // * Incremented every time the program is reloaded; caches
+            //   of reflected program data should be rebuilt when it
+            //   changes
+            u32 GetGeneration() const;
+
+            // * The AttributeBindings revision this program was
+            //   linked with; its attribute locations only match
+            //   the registry while the revision is unchanged
+            u32 GetAttributeBindingsRevision() const;
+
             void GLEnable(StateSet * state_set);
-            void GLDisable();
+            void GLDisable(StateSet * state_set);
             void GLCleanUp();
 
             // GLSetUniform
+            // * Values are uploaded with the glUniform call that
+            //   matches their type (bool values are sent as ints)
+            // * With KS_DEBUG_GL, values whose type doesn't match
+            //   the uniform's reflected type are rejected
             void GLSetUniform(std::string const &name,GLint i);
             void GLSetUniform(std::string const &name,GLfloat f);
             void GLSetUniform(std::string const &name,glm::vec2 const &v2);
             void GLSetUniform(std::string const &name,glm::vec3 const &v3);
             void GLSetUniform(std::string const &name,glm::vec4 const &v4);
             void GLSetUniform(std::string const &name,glm::mat4 const &m4);
+            void GLSetUniform(std::string const &name,glm::ivec2 const &iv2);
+            void GLSetUniform(std::string const &name,glm::ivec3 const &iv3);
+            void GLSetUniform(std::string const &name,glm::ivec4 const &iv4);
+            void GLSetUniform(std::string const &name,glm::mat2 const &m2);
+            void GLSetUniform(std::string const &name,glm::mat3 const &m3);
+            void GLSetUniform(std::string const &name,Sampler const &sampler);
+            void GLSetUniform(std::string const &name,bool b);
+            void GLSetUniform(std::string const &name,glm::bvec2 const &bv2);
+            void GLSetUniform(std::string const &name,glm::bvec3 const &bv3);
+            void GLSetUniform(std::string const &name,glm::bvec4 const &bv4);
 
             void GLSetUniform(std::string const &name,std::vector<GLint> const &ia);
             void GLSetUniform(std::string const &name,std::vector<GLfloat> const &fa);
@@ -90,6 +227,70 @@ namespace ks
             void GLSetUniform(std::string const &name,std::vector<glm::vec3> const &v3a);
             void GLSetUniform(std::string const &name,std::vector<glm::vec4> const &v4a);
             void GLSetUniform(std::string const &name,std::vector<glm::mat4> const &m4a);
+            void GLSetUniform(std::string const &name,std::vector<glm::ivec2> const &iv2a);
+            void GLSetUniform(std::string const &name,std::vector<glm::ivec3> const &iv3a);
+            void GLSetUniform(std::string const &name,std::vector<glm::ivec4> const &iv4a);
+            void GLSetUniform(std::string const &name,std::vector<glm::mat2> const &m2a);
+            void GLSetUniform(std::string const &name,std::vector<glm::mat3> const &m3a);
+            void GLSetUniform(std::string const &name,std::vector<Sampler> const &samplera);
+            void GLSetUniform(std::string const &name,std::vector<bool> const &ba);
+            void GLSetUniform(std::string const &name,std::vector<glm::bvec2> const &bv2a);
+            void GLSetUniform(std::string const &name,std::vector<glm::bvec3> const &bv3a);
+            void GLSetUniform(std::string const &name,std::vector<glm::bvec4> const &bv4a);
+
+            // GLSetUniform (by handle)
+            void GLSetUniform(UniformHandle const &handle,GLint i);
+            void GLSetUniform(UniformHandle const &handle,GLfloat f);
+            void GLSetUniform(UniformHandle const &handle,glm::vec2 const &v2);
+            void GLSetUniform(UniformHandle const &handle,glm::vec3 const &v3);
+            void GLSetUniform(UniformHandle const &handle,glm::vec4 const &v4);
+            void GLSetUniform(UniformHandle const &handle,glm::mat4 const &m4);
+            void GLSetUniform(UniformHandle const &handle,glm::ivec2 const &iv2);
+            void GLSetUniform(UniformHandle const &handle,glm::ivec3 const &iv3);
+            void GLSetUniform(UniformHandle const &handle,glm::ivec4 const &iv4);
+            void GLSetUniform(UniformHandle const &handle,glm::mat2 const &m2);
+            void GLSetUniform(UniformHandle const &handle,glm::mat3 const &m3);
+            void GLSetUniform(UniformHandle const &handle,Sampler const &sampler);
+            void GLSetUniform(UniformHandle const &handle,bool b);
+            void GLSetUniform(UniformHandle const &handle,glm::bvec2 const &bv2);
+            void GLSetUniform(UniformHandle const &handle,glm::bvec3 const &bv3);
+            void GLSetUniform(UniformHandle const &handle,glm::bvec4 const &bv4);
+
+            void GLSetUniform(UniformHandle const &handle,std::vector<GLint> const &ia);
+            void GLSetUniform(UniformHandle const &handle,std::vector<GLfloat> const &fa);
+            void GLSetUniform(UniformHandle const &handle,std::vector<glm::vec2> const &v2a);
+            void GLSetUniform(UniformHandle const &handle,std::vector<glm::vec3> const &v3a);
+            void GLSetUniform(UniformHandle const &handle,std::vector<glm::vec4> const &v4a);
+            void GLSetUniform(UniformHandle const &handle,std::vector<glm::mat4> const &m4a);
+            void GLSetUniform(UniformHandle const &handle,std::vector<glm::ivec2> const &iv2a);
+            void GLSetUniform(UniformHandle const &handle,std::vector<glm::ivec3> const &iv3a);
+            void GLSetUniform(UniformHandle const &handle,std::vector<glm::ivec4> const &iv4a);
+            void GLSetUniform(UniformHandle const &handle,std::vector<glm::mat2> const &m2a);
+            void GLSetUniform(UniformHandle const &handle,std::vector<glm::mat3> const &m3a);
+            void GLSetUniform(UniformHandle const &handle,std::vector<Sampler> const &samplera);
+            void GLSetUniform(UniformHandle const &handle,std::vector<bool> const &ba);
+            void GLSetUniform(UniformHandle const &handle,std::vector<glm::bvec2> const &bv2a);
+            void GLSetUniform(UniformHandle const &handle,std::vector<glm::bvec3> const &bv3a);
+            void GLSetUniform(UniformHandle const &handle,std::vector<glm::bvec4> const &bv4a);
+
+            // * Sets @count elements of a uniform array starting
+            //   at element @index
+            void GLSetUniform(UniformHandle const &handle,uint index,GLint const * ia,uint count);
+            void GLSetUniform(UniformHandle const &handle,uint index,GLfloat const * fa,uint count);
+            void GLSetUniform(UniformHandle const &handle,uint index,glm::vec2 const * v2a,uint count);
+            void GLSetUniform(UniformHandle const &handle,uint index,glm::vec3 const * v3a,uint count);
+            void GLSetUniform(UniformHandle const &handle,uint index,glm::vec4 const * v4a,uint count);
+            void GLSetUniform(UniformHandle const &handle,uint index,glm::mat4 const * m4a,uint count);
+            void GLSetUniform(UniformHandle const &handle,uint index,glm::ivec2 const * iv2a,uint count);
+            void GLSetUniform(UniformHandle const &handle,uint index,glm::ivec3 const * iv3a,uint count);
+            void GLSetUniform(UniformHandle const &handle,uint index,glm::ivec4 const * iv4a,uint count);
+            void GLSetUniform(UniformHandle const &handle,uint index,glm::mat2 const * m2a,uint count);
+            void GLSetUniform(UniformHandle const &handle,uint index,glm::mat3 const * m3a,uint count);
+            void GLSetUniform(UniformHandle const &handle,uint index,Sampler const * samplera,uint count);
+            void GLSetUniform(UniformHandle const &handle,uint index,bool const * ba,uint count);
+            void GLSetUniform(UniformHandle const &handle,uint index,glm::bvec2 const * bv2a,uint count);
+            void GLSetUniform(UniformHandle const &handle,uint index,glm::bvec3 const * bv3a,uint count);
+            void GLSetUniform(UniformHandle const &handle,uint index,glm::bvec4 const * bv4a,uint count);
 
         private:
             struct VxAttrDesc {
@@ -101,23 +302,61 @@ namespace ks
                 std::string name;
                 GLint location;
                 GLenum type;
+                u32 name_id;
+
+                uint elem_size;
+                uint elem_count; // array size from this location on
+                uint elem_index; // into m_list_elem_locations and
+                                 // m_list_shadow_valid
+                uint shadow_offset; // into m_shadow_data
             };
 
-            bool loadShaderFromSource(std::string const &shader_source,
+            UniformDesc const * findUniform(std::string const &name) const;
+            UniformDesc const * findUniform(UniformHandle const &handle) const;
+            UniformDesc const * findUniformByNameId(u32 name_id) const;
+
+            // * Sets the values of any uniforms shadowed by @other
+            //   on this program if they match
+            void copyUniformValues(StateSet* state_set,
+                                   ShaderProgram const &other);
+
+            // * Uploads @count elements of @data starting at
+            //   element @index of the uniform
+            // * Only runs of elements that differ from the shadow
+            //   copy are uploaded
+            template<typename T>
+            void setUniform(UniformDesc const * desc,
+                            uint index,
+                            T const * data,
+                            uint count);
+
+            bool linkFromBinary(u64 cache_key);
+            bool submitSource(bool retrievable);
+            bool finishSource();
+            void cleanUpHandles();
+
+            void loadShaderFromSource(std::string const &shader_source,
                                       GLuint const shader_handle);
+            bool checkShaderCompiled(GLuint const shader_handle);
 
             bool getAttributes();
             bool getUniforms();
 
             std::string m_desc;
-            std::string const m_source_vsh;
-            std::string const m_source_fsh;
+            std::string m_source_vsh;
+            std::string m_source_fsh;
             std::string m_glsl_version;
 
             GLuint m_handle_prog;
             GLuint m_handle_vsh;
             GLuint m_handle_fsh;
             bool m_init;
+            Status m_status;
+            bool m_parallel_compile;
+            bool m_use_binary_cache;
+            u64 m_binary_cache_key;
+            u32 m_generation;
+            u32 m_attr_bindings_revision;
 
             std::string m_log_prefix;
 
@@ -126,6 +365,19 @@ namespace ks
             std::vector<VxAttrDesc>  m_list_attributes;
             std::vector<UniformDesc> m_list_uniforms;
 
+            // location of every element of every uniform,
+            // arrays are expanded
+            std::vector<GLint> m_list_elem_locations;
+
+            // index into m_list_uniforms by UniformHandle id,
+            // -1 if this program doesn't have the uniform
+            std::vector<sint> m_lkup_uniform_by_name_id;
+
+            // last uploaded uniform values, invalid until set
+            std::vector<u8> m_shadow_data;
+            std::vector<bool> m_list_shadow_valid;
+            UniformStats m_uniform_stats;
+
             // list of which vertex attribute locations
             // are used in this shader
             std::vector<bool> m_list_attribs_used;
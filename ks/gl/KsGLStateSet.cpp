@@ -16,123 +16,222 @@
 
 
 #include <sstream>
+#include <chrono>
+#include <algorithm>
 #include <ks/gl/KsGLStateSet.hpp>
 #include <ks/gl/KsGLImplementation.hpp>
+#include <ks/gl/KsGLStats.hpp>
+
+#ifndef GL_UNPACK_ROW_LENGTH
+#define GL_UNPACK_ROW_LENGTH 0x0CF2 // GL_UNPACK_ROW_LENGTH_EXT
+#endif
 
 namespace ks
 {
     namespace gl
     {
         // Helpers for capturing state from the GL context
+        // * Each helper increments @gl_get_count so the
+        //   cost of a capture can be measured
         namespace {
 
             template<typename T>
-            void assignBooleanFromGL(StateSet::State<T> &state,GLenum gl_enum)
+            void assignBooleanFromGL(StateSet::State<T> &state,GLenum gl_enum,uint &gl_get_count)
             {
                 GLboolean temp;
                 glGetBooleanv(gl_enum,&temp);
                 state.valid = true;
                 state.value = temp;
+                gl_get_count++;
             }
 
             template<typename T>
-            void assignIntegerFromGL(StateSet::State<T> &state, GLenum gl_enum)
+            void assignIntegerFromGL(StateSet::State<T> &state, GLenum gl_enum,uint &gl_get_count)
             {
                 GLint temp;
                 glGetIntegerv(gl_enum,&temp);
                 state.valid = true;
                 state.value = temp;
+                gl_get_count++;
             }
 
             template<typename T>
-            void assignFloatFromGL(StateSet::State<T> &state, GLenum gl_enum)
+            void assignFloatFromGL(StateSet::State<T> &state, GLenum gl_enum,uint &gl_get_count)
             {
                 GLfloat temp;
                 glGetFloatv(gl_enum,&temp);
                 state.valid = true;
                 state.value = temp;
+                gl_get_count++;
             }
         }
 
-        void StateSet::CaptureState()
+        void StateSet::CaptureState(u32 categories)
         {
-            m_data.gl_vertex_attrib_array_enabled.resize(
-                        Implementation::GetMaxVertexAttribs());
+            auto const capture_start = std::chrono::steady_clock::now();
 
-            m_data.list_texture_bindstates.resize(
-                        Implementation::GetMaxTextureImageUnits());
+            m_capture_stats.categories = categories;
+            m_capture_stats.gl_get_count = 0;
+            uint &n = m_capture_stats.gl_get_count;
 
-            // stencil
-            assignBooleanFromGL(m_data.gl_scissor_test,GL_SCISSOR_TEST);
+            setImplementationLimits();
+
+            // framebuffer
+            if(categories & Category::FrameBuffer) {
+                assignIntegerFromGL(m_data.gl_framebuffer_binding,GL_FRAMEBUFFER_BINDING,n);
+            }
+
+            // program and buffers
+            if(categories & Category::Program) {
+                assignIntegerFromGL(m_data.gl_current_program,GL_CURRENT_PROGRAM,n);
+            }
+
+            if(categories & Category::Buffers) {
+                assignIntegerFromGL(m_data.gl_array_buffer_binding,GL_ARRAY_BUFFER_BINDING,n);
+                assignIntegerFromGL(m_data.gl_element_array_buffer_binding,GL_ELEMENT_ARRAY_BUFFER_BINDING,n);
+            }
+
+            // textures
+            if(categories & Category::Textures) {
+                assignIntegerFromGL(m_data.gl_active_texture,GL_ACTIVE_TEXTURE,n);
+                m_data.gl_active_texture.value -= GL_TEXTURE0;
+
+                // Bound textures are tracked by uid which
+                // can't be queried so they're invalidated
+                for(auto &bindstate : m_data.list_texture_bindstates) {
+                    bindstate.valid = false;
+                }
+            }
+
+            // viewport
+            if(categories & Category::Viewport) {
+                GLint vp[4];
+                glGetIntegerv(GL_VIEWPORT,&(vp[0]));
+                setState(m_data.gl_viewport,Rect{vp[0],vp[1],vp[2],vp[3]});
+                n++;
+            }
+
+            // scissor
+            if(categories & Category::Scissor) {
+                assignBooleanFromGL(m_data.gl_scissor_test,GL_SCISSOR_TEST,n);
+
+                GLint sb[4];
+                glGetIntegerv(GL_SCISSOR_BOX,&(sb[0]));
+                setState(m_data.gl_scissor_box,Rect{sb[0],sb[1],sb[2],sb[3]});
+                n++;
+            }
+
+            // color mask
+            if(categories & Category::ColorMask) {
+                GLboolean cwm[4];
+                glGetBooleanv(GL_COLOR_WRITEMASK,&(cwm[0]));
+                setState(m_data.gl_color_writemask,ColorMask{cwm[0],cwm[1],cwm[2],cwm[3]});
+                n++;
+            }
+
+            // rasterization
+            if(categories & Category::Raster) {
+                assignFloatFromGL(m_data.gl_line_width,GL_LINE_WIDTH,n);
+                assignBooleanFromGL(m_data.gl_dither,GL_DITHER,n);
+            }
 
             // blend
-            assignBooleanFromGL(m_data.gl_blend,GL_BLEND);
-            assignIntegerFromGL(m_data.gl_blend_src_rgb,GL_BLEND_SRC_RGB);
-            assignIntegerFromGL(m_data.gl_blend_src_alpha,GL_BLEND_SRC_ALPHA);
-            assignIntegerFromGL(m_data.gl_blend_dst_rgb,GL_BLEND_DST_RGB);
-            assignIntegerFromGL(m_data.gl_blend_dst_alpha,GL_BLEND_DST_ALPHA);
-            assignIntegerFromGL(m_data.gl_blend_equation_rgb,GL_BLEND_EQUATION_RGB);
-            assignIntegerFromGL(m_data.gl_blend_equation_alpha,GL_BLEND_EQUATION_ALPHA);
+            if(categories & Category::Blend) {
+                assignBooleanFromGL(m_data.gl_blend,GL_BLEND,n);
+                assignIntegerFromGL(m_data.gl_blend_src_rgb,GL_BLEND_SRC_RGB,n);
+                assignIntegerFromGL(m_data.gl_blend_src_alpha,GL_BLEND_SRC_ALPHA,n);
+                assignIntegerFromGL(m_data.gl_blend_dst_rgb,GL_BLEND_DST_RGB,n);
+                assignIntegerFromGL(m_data.gl_blend_dst_alpha,GL_BLEND_DST_ALPHA,n);
+                assignIntegerFromGL(m_data.gl_blend_equation_rgb,GL_BLEND_EQUATION_RGB,n);
+                assignIntegerFromGL(m_data.gl_blend_equation_alpha,GL_BLEND_EQUATION_ALPHA,n);
+            }
 
             // depth
-            assignBooleanFromGL(m_data.gl_depth_test,GL_DEPTH_TEST);
-            assignBooleanFromGL(m_data.gl_depth_writemask,GL_DEPTH_WRITEMASK);
-            assignIntegerFromGL(m_data.gl_depth_func,GL_DEPTH_FUNC);
-
-            GLfloat depth_range[2];
-            glGetFloatv(GL_DEPTH_RANGE,&(depth_range[0]));
-            setState(m_data.gl_depth_range_near,depth_range[0]);
-            setState(m_data.gl_depth_range_near,depth_range[1]);
+            if(categories & Category::Depth) {
+                assignBooleanFromGL(m_data.gl_depth_test,GL_DEPTH_TEST,n);
+                assignBooleanFromGL(m_data.gl_depth_writemask,GL_DEPTH_WRITEMASK,n);
+                assignIntegerFromGL(m_data.gl_depth_func,GL_DEPTH_FUNC,n);
+
+                GLfloat depth_range[2];
+                glGetFloatv(GL_DEPTH_RANGE,&(depth_range[0]));
+                setState(m_data.gl_depth_range_near,depth_range[0]);
+                setState(m_data.gl_depth_range_far,depth_range[1]);
+                n++;
+            }
 
             // stencil
-            assignIntegerFromGL(m_data.gl_stencil_writemask,GL_STENCIL_WRITEMASK);
-            assignIntegerFromGL(m_data.gl_stencil_back_writemask,GL_STENCIL_BACK_WRITEMASK);
-            assignBooleanFromGL(m_data.gl_stencil_test,GL_STENCIL_TEST);
-            assignIntegerFromGL(m_data.gl_stencil_func,GL_STENCIL_FUNC);
-            assignIntegerFromGL(m_data.gl_stencil_value_mask,GL_STENCIL_VALUE_MASK);
-            assignIntegerFromGL(m_data.gl_stencil_ref,GL_STENCIL_REF);
-            assignIntegerFromGL(m_data.gl_stencil_back_func,GL_STENCIL_BACK_FUNC);
-            assignIntegerFromGL(m_data.gl_stencil_back_value_mask,GL_STENCIL_BACK_VALUE_MASK);
-            assignIntegerFromGL(m_data.gl_stencil_back_ref,GL_STENCIL_BACK_REF);
-
-            assignIntegerFromGL(m_data.gl_stencil_fail,GL_STENCIL_FAIL);
-            assignIntegerFromGL(m_data.gl_stencil_pass_depth_pass,GL_STENCIL_PASS_DEPTH_PASS);
-            assignIntegerFromGL(m_data.gl_stencil_pass_depth_fail,GL_STENCIL_PASS_DEPTH_FAIL);
-            assignIntegerFromGL(m_data.gl_stencil_back_fail,GL_STENCIL_BACK_FAIL);
-            assignIntegerFromGL(m_data.gl_stencil_back_pass_depth_pass,GL_STENCIL_BACK_PASS_DEPTH_PASS);
-            assignIntegerFromGL(m_data.gl_stencil_back_pass_depth_fail,GL_STENCIL_BACK_PASS_DEPTH_FAIL);
+            if(categories & Category::Stencil) {
+                assignIntegerFromGL(m_data.gl_stencil_writemask,GL_STENCIL_WRITEMASK,n);
+                assignIntegerFromGL(m_data.gl_stencil_back_writemask,GL_STENCIL_BACK_WRITEMASK,n);
+                assignBooleanFromGL(m_data.gl_stencil_test,GL_STENCIL_TEST,n);
+                assignIntegerFromGL(m_data.gl_stencil_func,GL_STENCIL_FUNC,n);
+                assignIntegerFromGL(m_data.gl_stencil_value_mask,GL_STENCIL_VALUE_MASK,n);
+                assignIntegerFromGL(m_data.gl_stencil_ref,GL_STENCIL_REF,n);
+                assignIntegerFromGL(m_data.gl_stencil_back_func,GL_STENCIL_BACK_FUNC,n);
+                assignIntegerFromGL(m_data.gl_stencil_back_value_mask,GL_STENCIL_BACK_VALUE_MASK,n);
+                assignIntegerFromGL(m_data.gl_stencil_back_ref,GL_STENCIL_BACK_REF,n);
+
+                assignIntegerFromGL(m_data.gl_stencil_fail,GL_STENCIL_FAIL,n);
+                assignIntegerFromGL(m_data.gl_stencil_pass_depth_pass,GL_STENCIL_PASS_DEPTH_PASS,n);
+                assignIntegerFromGL(m_data.gl_stencil_pass_depth_fail,GL_STENCIL_PASS_DEPTH_FAIL,n);
+                assignIntegerFromGL(m_data.gl_stencil_back_fail,GL_STENCIL_BACK_FAIL,n);
+                assignIntegerFromGL(m_data.gl_stencil_back_pass_depth_pass,GL_STENCIL_BACK_PASS_DEPTH_PASS,n);
+                assignIntegerFromGL(m_data.gl_stencil_back_pass_depth_fail,GL_STENCIL_BACK_PASS_DEPTH_FAIL,n);
+            }
 
             // cull
-            assignBooleanFromGL(m_data.gl_cull_face,GL_CULL_FACE);
-            assignIntegerFromGL(m_data.gl_cull_face_mode,GL_CULL_FACE_MODE);
+            if(categories & Category::Cull) {
+                assignBooleanFromGL(m_data.gl_cull_face,GL_CULL_FACE,n);
+                assignIntegerFromGL(m_data.gl_cull_face_mode,GL_CULL_FACE_MODE,n);
+            }
 
             // texture pack
-            assignIntegerFromGL(m_data.gl_pack_alignment,GL_PACK_ALIGNMENT);
-            assignIntegerFromGL(m_data.gl_unpack_alignment,GL_UNPACK_ALIGNMENT);
+            if(categories & Category::PixelStore) {
+                assignIntegerFromGL(m_data.gl_pack_alignment,GL_PACK_ALIGNMENT,n);
+                assignIntegerFromGL(m_data.gl_unpack_alignment,GL_UNPACK_ALIGNMENT,n);
+                if(Implementation::GetUnpackRowLengthSupported()) {
+                    assignIntegerFromGL(m_data.gl_unpack_row_length,GL_UNPACK_ROW_LENGTH,n);
+                }
+            }
 
             // polygon offset
-            assignBooleanFromGL(m_data.gl_polygon_offset_fill,GL_POLYGON_OFFSET_FILL);
-            assignFloatFromGL(m_data.gl_polygon_offset_factor,GL_POLYGON_OFFSET_FACTOR);
-            assignFloatFromGL(m_data.gl_polygon_offset_units,GL_POLYGON_OFFSET_UNITS);
+            if(categories & Category::PolygonOffset) {
+                assignBooleanFromGL(m_data.gl_polygon_offset_fill,GL_POLYGON_OFFSET_FILL,n);
+                assignFloatFromGL(m_data.gl_polygon_offset_factor,GL_POLYGON_OFFSET_FACTOR,n);
+                assignFloatFromGL(m_data.gl_polygon_offset_units,GL_POLYGON_OFFSET_UNITS,n);
+            }
 
             // clear
-            GLfloat clc[4];
-            glGetFloatv(GL_COLOR_CLEAR_VALUE,&(clc[0]));
-            setState(m_data.gl_color_clear_value,Color{clc[0],clc[1],clc[2],clc[3]});
-
-            assignFloatFromGL(m_data.gl_depth_clear_value,GL_DEPTH_CLEAR_VALUE);
-            assignIntegerFromGL(m_data.gl_stencil_clear_value,GL_STENCIL_CLEAR_VALUE);
+            if(categories & Category::Clear) {
+                GLfloat clc[4];
+                glGetFloatv(GL_COLOR_CLEAR_VALUE,&(clc[0]));
+                setState(m_data.gl_color_clear_value,Color{clc[0],clc[1],clc[2],clc[3]});
+                n++;
+
+                assignFloatFromGL(m_data.gl_depth_clear_value,GL_DEPTH_CLEAR_VALUE,n);
+                assignIntegerFromGL(m_data.gl_stencil_clear_value,GL_STENCIL_CLEAR_VALUE,n);
+            }
 
             KS_CHECK_GL_ERROR(m_log_prefix+"capture general state");
 
             // vertex attributes
-            for(size_t i=0; i < m_data.gl_vertex_attrib_array_enabled.size(); i++) {
-                GLint is_enabled;
-                glGetVertexAttribiv(i,GL_VERTEX_ATTRIB_ARRAY_ENABLED,&is_enabled);
-                m_data.gl_vertex_attrib_array_enabled[i].value = (is_enabled == 0) ? false : true;
-                m_data.gl_vertex_attrib_array_enabled[i].valid = true;
+            if(categories & Category::VertexAttribs) {
+                for(size_t i=0; i < m_data.gl_vertex_attrib_array_enabled.size(); i++) {
+                    GLint is_enabled;
+                    glGetVertexAttribiv(i,GL_VERTEX_ATTRIB_ARRAY_ENABLED,&is_enabled);
+                    m_data.gl_vertex_attrib_array_enabled[i].value = (is_enabled == 0) ? false : true;
+                    m_data.gl_vertex_attrib_array_enabled[i].valid = true;
+                    n++;
+                }
+                for(auto &attrib_pointer : m_data.list_vertex_attrib_pointers) {
+                    attrib_pointer.valid = false;
+                }
+                KS_CHECK_GL_ERROR(m_log_prefix+"capture enabled vx attribs");
             }
-            KS_CHECK_GL_ERROR(m_log_prefix+"capture enabled vx attribs");
+
+            m_capture_stats.duration_ns =
+                    std::chrono::duration_cast<std::chrono::nanoseconds>(
+                        std::chrono::steady_clock::now()-capture_start).count();
 
 //            LOG.Info() << m_log_prefix << "GL_VERTEX_ATTRIB_ARRAY_ENABLED:";
 //            std::string list_vx_attr_enabled;
@@ -145,16 +244,136 @@ namespace ks
 //            LOG.Info() << m_log_prefix << list_vx_attr_enabled;
         }
 
-        void StateSet::SetStateInvalid()
+        void StateSet::SetStateInvalid(u32 categories)
         {
-            m_data = Data();
+            // No GL calls are made here; any Set call for an
+            // invalidated state will be issued unconditionally
+            // and revalidate that state
+            setImplementationLimits();
+
+            if(categories & Category::FrameBuffer) {
+                m_data.gl_framebuffer_binding.valid = false;
+            }
+
+            if(categories & Category::Program) {
+                m_data.gl_current_program.valid = false;
+            }
+
+            if(categories & Category::Buffers) {
+                m_data.gl_array_buffer_binding.valid = false;
+                m_data.gl_element_array_buffer_binding.valid = false;
+            }
+
+            if(categories & Category::VertexAttribs) {
+                for(auto &attrib_enabled : m_data.gl_vertex_attrib_array_enabled) {
+                    attrib_enabled.valid = false;
+                }
+                for(auto &attrib_pointer : m_data.list_vertex_attrib_pointers) {
+                    attrib_pointer.valid = false;
+                }
+            }
+
+            if(categories & Category::Textures) {
+                m_data.gl_active_texture.valid = false;
+                for(auto &bindstate : m_data.list_texture_bindstates) {
+                    bindstate.valid = false;
+                }
+            }
+
+            if(categories & Category::Viewport) {
+                m_data.gl_viewport.valid = false;
+            }
+
+            if(categories & Category::Scissor) {
+                m_data.gl_scissor_test.valid = false;
+                m_data.gl_scissor_box.valid = false;
+            }
+
+            if(categories & Category::ColorMask) {
+                m_data.gl_color_writemask.valid = false;
+            }
+
+            if(categories & Category::Raster) {
+                m_data.gl_line_width.valid = false;
+                m_data.gl_dither.valid = false;
+            }
+
+            if(categories & Category::Blend) {
+                m_data.gl_blend.valid = false;
+                m_data.gl_blend_src_rgb.valid = false;
+                m_data.gl_blend_src_alpha.valid = false;
+                m_data.gl_blend_dst_rgb.valid = false;
+                m_data.gl_blend_dst_alpha.valid = false;
+                m_data.gl_blend_equation_rgb.valid = false;
+                m_data.gl_blend_equation_alpha.valid = false;
+            }
+
+            if(categories & Category::Depth) {
+                m_data.gl_depth_test.valid = false;
+                m_data.gl_depth_writemask.valid = false;
+                m_data.gl_depth_func.valid = false;
+                m_data.gl_depth_range_near.valid = false;
+                m_data.gl_depth_range_far.valid = false;
+            }
+
+            if(categories & Category::Stencil) {
+                m_data.gl_stencil_writemask.valid = false;
+                m_data.gl_stencil_back_writemask.valid = false;
+                m_data.gl_stencil_test.valid = false;
+                m_data.gl_stencil_func.valid = false;
+                m_data.gl_stencil_value_mask.valid = false;
+                m_data.gl_stencil_ref.valid = false;
+                m_data.gl_stencil_back_func.valid = false;
+                m_data.gl_stencil_back_value_mask.valid = false;
+                m_data.gl_stencil_back_ref.valid = false;
+                m_data.gl_stencil_fail.valid = false;
+                m_data.gl_stencil_pass_depth_pass.valid = false;
+                m_data.gl_stencil_pass_depth_fail.valid = false;
+                m_data.gl_stencil_back_fail.valid = false;
+                m_data.gl_stencil_back_pass_depth_pass.valid = false;
+                m_data.gl_stencil_back_pass_depth_fail.valid = false;
+            }
+
+            if(categories & Category::Cull) {
+                m_data.gl_cull_face.valid = false;
+                m_data.gl_cull_face_mode.valid = false;
+            }
+
+            if(categories & Category::PixelStore) {
+                m_data.gl_pack_alignment.valid = false;
+                m_data.gl_unpack_alignment.valid = false;
+                m_data.gl_unpack_row_length.valid = false;
+            }
 
-            // Set implementation specific resource limits
-            m_data.gl_vertex_attrib_array_enabled.resize(
-                        Implementation::GetMaxVertexAttribs());
+            if(categories & Category::PolygonOffset) {
+                m_data.gl_polygon_offset_fill.valid = false;
+                m_data.gl_polygon_offset_factor.valid = false;
+                m_data.gl_polygon_offset_units.valid = false;
+            }
 
-            m_data.list_texture_bindstates.resize(
-                        Implementation::GetMaxTextureImageUnits());
+            if(categories & Category::Clear) {
+                m_data.gl_color_clear_value.valid = false;
+                m_data.gl_depth_clear_value.valid = false;
+                m_data.gl_stencil_clear_value.valid = false;
+            }
+        }
+
+        void StateSet::setImplementationLimits()
+        {
+            // Only resized once; the limits don't change
+            // for the lifetime of the context
+            if(m_data.gl_vertex_attrib_array_enabled.empty()) {
+                m_data.gl_vertex_attrib_array_enabled.resize(
+                            Implementation::GetMaxVertexAttribs());
+
+                m_data.list_vertex_attrib_pointers.resize(
+                            m_data.gl_vertex_attrib_array_enabled.size());
+            }
+
+            if(m_data.list_texture_bindstates.empty()) {
+                m_data.list_texture_bindstates.resize(
+                            Implementation::GetMaxTextureImageUnits());
+            }
         }
 
 
@@ -163,20 +382,84 @@ namespace ks
         void StateSet::SetFrameBuffer(GLint fb_handle)
         {
             if(compareState(m_data.gl_framebuffer_binding,fb_handle)) {
+                KS_GL_STATS_FILTERED(FrameBuffer);
                 return;
             }
 
             glBindFramebuffer(GL_FRAMEBUFFER,fb_handle);
             KS_CHECK_GL_ERROR(m_log_prefix+"set framebuffer");
+            KS_GL_STATS_ISSUED(FrameBuffer);
             setState(m_data.gl_framebuffer_binding,fb_handle);
         }
 
+        void StateSet::SetFrameBufferDeleted(GLint fb_handle)
+        {
+            // Deleting the bound framebuffer reverts the binding to 0
+            if(compareState(m_data.gl_framebuffer_binding,fb_handle)) {
+                setState(m_data.gl_framebuffer_binding,0);
+            }
+        }
+
+        void StateSet::SetProgram(GLint prog_handle)
+        {
+            if(compareState(m_data.gl_current_program,prog_handle)) {
+                KS_GL_STATS_FILTERED(Program);
+                return;
+            }
+
+            glUseProgram(prog_handle);
+            KS_CHECK_GL_ERROR(m_log_prefix+"set program");
+            KS_GL_STATS_ISSUED(Program);
+            setState(m_data.gl_current_program,prog_handle);
+        }
+
+        void StateSet::SetBuffer(GLenum target,GLint buff_handle)
+        {
+            State<GLint>& binding =
+                    (target == GL_ARRAY_BUFFER) ?
+                        m_data.gl_array_buffer_binding :
+                        m_data.gl_element_array_buffer_binding;
+
+            assert((target == GL_ARRAY_BUFFER) ||
+                   (target == GL_ELEMENT_ARRAY_BUFFER));
+
+            if(compareState(binding,buff_handle)) {
+                KS_GL_STATS_FILTERED(Buffer);
+                return;
+            }
+
+            glBindBuffer(target,buff_handle);
+            KS_CHECK_GL_ERROR(m_log_prefix+"bind buffer");
+            KS_GL_STATS_ISSUED(Buffer);
+            setState(binding,buff_handle);
+        }
+
+        void StateSet::SetBufferDeleted(GLint buff_handle)
+        {
+            // Deleting a bound buffer reverts the binding to 0
+            if(compareState(m_data.gl_array_buffer_binding,buff_handle)) {
+                setState(m_data.gl_array_buffer_binding,0);
+            }
+            if(compareState(m_data.gl_element_array_buffer_binding,buff_handle)) {
+                setState(m_data.gl_element_array_buffer_binding,0);
+            }
+
+            // Vertex attribute pointers keep referencing the
+            // deleted buffer, but its handle may be reused
+            for(auto &attrib_pointer : m_data.list_vertex_attrib_pointers) {
+                if(attrib_pointer.valid && attrib_pointer.value.buffer == buff_handle) {
+                    attrib_pointer.valid = false;
+                }
+            }
+        }
+
         void StateSet::SetVertexAttributeEnabled(GLuint location,bool enabled)
         {
             assert((m_data.gl_vertex_attrib_array_enabled.size() > 0) &&
                    (location < m_data.gl_vertex_attrib_array_enabled.size()));
 
             if(compareState(m_data.gl_vertex_attrib_array_enabled[location],enabled)) {
+                KS_GL_STATS_FILTERED(VertexAttrib);
                 return;
             }
 
@@ -190,10 +473,59 @@ namespace ks
             KS_CHECK_GL_ERROR(m_log_prefix+"set vertex attrib enabled: "+
                                    ConvNumberToString(location)+": "+
                                    ConvBoolToString(enabled));
+            KS_GL_STATS_ISSUED(VertexAttrib);
 
             setState(m_data.gl_vertex_attrib_array_enabled[location],enabled);
         }
 
+        void StateSet::SetVertexAttribPointer(GLuint location,
+                                              GLint size,
+                                              GLenum type,
+                                              GLboolean normalized,
+                                              GLsizei stride,
+                                              std::uintptr_t offset)
+        {
+            assert((m_data.list_vertex_attrib_pointers.size() > 0) &&
+                   (location < m_data.list_vertex_attrib_pointers.size()));
+
+            // The pointer refers to whatever buffer is bound
+            // so it can only be tracked if the binding is known
+            bool const buffer_known = m_data.gl_array_buffer_binding.valid;
+
+            VertexAttribPointer const attrib_pointer{
+                m_data.gl_array_buffer_binding.value,
+                size,
+                type,
+                normalized,
+                stride,
+                offset
+            };
+
+            if(buffer_known &&
+               compareState(m_data.list_vertex_attrib_pointers[location],attrib_pointer)) {
+                KS_GL_STATS_FILTERED(VertexAttrib);
+                return;
+            }
+
+            glVertexAttribPointer(location,
+                                  size,
+                                  type,
+                                  normalized,
+                                  stride,
+                                  reinterpret_cast<const void*>(offset));
+
+            KS_CHECK_GL_ERROR(m_log_prefix+"set vertex attrib pointer: "+
+                              ConvNumberToString(location));
+            KS_GL_STATS_ISSUED(VertexAttrib);
+
+            if(buffer_known) {
+                setState(m_data.list_vertex_attrib_pointers[location],attrib_pointer);
+            }
+            else {
+                m_data.list_vertex_attrib_pointers[location].valid = false;
+            }
+        }
+
         void StateSet::SetActiveTexUnitAndBind(GLint unit,GLint handle,GLenum target,uint64_t uid)
         {
             assert((m_data.list_texture_bindstates.size() > 0) &&
@@ -209,20 +541,138 @@ namespace ks
             if(!unit_already_set) {
                 glActiveTexture(GL_TEXTURE0 + unit);
                 KS_CHECK_GL_ERROR(m_log_prefix+"set active tex unit");
+                KS_GL_STATS_ISSUED(Texture);
                 setState(m_data.gl_active_texture,unit);
             }
+            else {
+                KS_GL_STATS_FILTERED(Texture);
+            }
 
             if(!handle_already_bound) {
                 glBindTexture(target,handle);
                 KS_CHECK_GL_ERROR(m_log_prefix+"bind texture");
+                KS_GL_STATS_ISSUED(Texture);
                 m_data.list_texture_bindstates[unit].uid = uid;
                 m_data.list_texture_bindstates[unit].valid = true;
             }
+            else {
+                KS_GL_STATS_FILTERED(Texture);
+            }
+
+            m_tex_unit_clock++;
+            m_data.list_texture_bindstates[unit].last_used = m_tex_unit_clock;
+        }
+
+        GLint StateSet::AllocTexUnitAndBind(GLint handle,GLenum target,u64 uid)
+        {
+            assert(m_data.list_texture_bindstates.size() > 0);
+
+            GLint unit = findTexUnit(uid);
+            if(unit < 0) {
+                unit = findLeastRecentTexUnit(m_tex_unit_clock);
+                SetActiveTexUnitAndBind(unit,handle,target,uid);
+            }
+            else {
+                // already resident; the active unit
+                // doesn't need to change
+                KS_GL_STATS_FILTERED(Texture);
+                m_tex_unit_clock++;
+                m_data.list_texture_bindstates[unit].last_used = m_tex_unit_clock;
+            }
+
+            return unit;
+        }
+
+        bool StateSet::AllocTexUnitsAndBind(std::vector<TextureDesc> const &list_textures,
+                                            std::vector<GLint> &list_tex_units)
+        {
+            if(list_textures.size() > m_data.list_texture_bindstates.size()) {
+                LOG.Error() << m_log_prefix
+                            << "AllocTexUnitsAndBind: more textures than "
+                               "texture units: " << list_textures.size();
+                return false;
+            }
+
+            // Units used after this timestamp belong to this
+            // set and must not be evicted
+            u64 const set_start = m_tex_unit_clock;
+
+            list_tex_units.assign(list_textures.size(),-1);
+
+            // Reuse units for textures that are already resident
+            // first so they can't be evicted by the others
+            for(size_t i=0; i < list_textures.size(); i++) {
+                GLint const unit = findTexUnit(list_textures[i].uid);
+                if(unit >= 0) {
+                    KS_GL_STATS_FILTERED(Texture);
+                    m_tex_unit_clock++;
+                    m_data.list_texture_bindstates[unit].last_used = m_tex_unit_clock;
+                    list_tex_units[i] = unit;
+                }
+            }
+
+            for(size_t i=0; i < list_textures.size(); i++) {
+                if(list_tex_units[i] >= 0) {
+                    continue;
+                }
+
+                auto const &tex = list_textures[i];
+
+                // the same texture may be listed more than once
+                GLint unit = findTexUnit(tex.uid);
+                if(unit < 0) {
+                    unit = findLeastRecentTexUnit(set_start);
+                    SetActiveTexUnitAndBind(unit,tex.handle,tex.target,tex.uid);
+                }
+                list_tex_units[i] = unit;
+            }
+
+            return true;
+        }
+
+        GLint StateSet::findTexUnit(u64 uid) const
+        {
+            auto const &list_bindstates = m_data.list_texture_bindstates;
+            for(size_t i=0; i < list_bindstates.size(); i++) {
+                if(list_bindstates[i].valid && list_bindstates[i].uid == uid) {
+                    return i;
+                }
+            }
+            return -1;
+        }
+
+        GLint StateSet::findLeastRecentTexUnit(u64 used_after) const
+        {
+            // * Units with a last_used time greater than
+            //   @used_after are skipped
+            // * Invalid units are preferred since nothing we
+            //   know of is bound to them
+            auto const &list_bindstates = m_data.list_texture_bindstates;
+
+            GLint lru_unit = -1;
+            for(size_t i=0; i < list_bindstates.size(); i++) {
+                auto const &bindstate = list_bindstates[i];
+
+                if(bindstate.last_used > used_after) {
+                    continue;
+                }
+                if(!bindstate.valid) {
+                    return i;
+                }
+                if(lru_unit < 0 ||
+                   bindstate.last_used < list_bindstates[lru_unit].last_used) {
+                    lru_unit = i;
+                }
+            }
+
+            assert(lru_unit >= 0);
+            return lru_unit;
         }
 
         void StateSet::SetScissorTest(GLboolean enabled)
         {
             if(compareState(m_data.gl_scissor_test,enabled)) {
+                KS_GL_STATS_FILTERED(Scissor);
                 return;
             }
 
@@ -233,13 +683,145 @@ namespace ks
                 glDisable(GL_SCISSOR_TEST);
             }
             KS_CHECK_GL_ERROR(m_log_prefix+"set scissor test");
+            KS_GL_STATS_ISSUED(Scissor);
 
             setState(m_data.gl_scissor_test,enabled);
         }
 
+        void StateSet::SetScissor(GLint x,GLint y,GLsizei width,GLsizei height)
+        {
+            Rect rect{x,y,width,height};
+
+            if(compareState(m_data.gl_scissor_box,rect)) {
+                KS_GL_STATS_FILTERED(Scissor);
+                return;
+            }
+
+            glScissor(x,y,width,height);
+            KS_CHECK_GL_ERROR(m_log_prefix+"set scissor box");
+            KS_GL_STATS_ISSUED(Scissor);
+            setState(m_data.gl_scissor_box,rect);
+        }
+
+        void StateSet::PushScissor(GLint x,GLint y,GLsizei width,GLsizei height)
+        {
+            Rect rect{x,y,width,height};
+
+            if(m_list_scissor_rects.empty()) {
+                m_scissor_test_before_push = m_data.gl_scissor_test;
+                m_scissor_box_before_push = m_data.gl_scissor_box;
+            }
+            else {
+                // intersect with the current clip rect
+                Rect const &top = m_list_scissor_rects.back();
+
+                GLint const x0 = std::max(top.x,rect.x);
+                GLint const y0 = std::max(top.y,rect.y);
+                GLint const x1 = std::min(top.x+top.width,rect.x+rect.width);
+                GLint const y1 = std::min(top.y+top.height,rect.y+rect.height);
+
+                rect = Rect{x0,y0,std::max(x1-x0,0),std::max(y1-y0,0)};
+            }
+
+            m_list_scissor_rects.push_back(rect);
+
+            SetScissorTest(GL_TRUE);
+            SetScissor(rect.x,rect.y,rect.width,rect.height);
+        }
+
+        void StateSet::PopScissor()
+        {
+            if(m_list_scissor_rects.empty()) {
+                LOG.Error() << m_log_prefix
+                            << "PopScissor called with empty stack";
+                return;
+            }
+
+            m_list_scissor_rects.pop_back();
+
+            if(!m_list_scissor_rects.empty()) {
+                Rect const &top = m_list_scissor_rects.back();
+                SetScissor(top.x,top.y,top.width,top.height);
+                return;
+            }
+
+            // restore the state from before the first push; if
+            // it was never set we assume the GL default (disabled)
+            SetScissorTest(m_scissor_test_before_push.valid ?
+                               m_scissor_test_before_push.value : GL_FALSE);
+
+            if(m_scissor_box_before_push.valid) {
+                Rect const &box = m_scissor_box_before_push.value;
+                SetScissor(box.x,box.y,box.width,box.height);
+            }
+        }
+
+        void StateSet::SetViewport(GLint x,GLint y,GLsizei width,GLsizei height)
+        {
+            Rect rect{x,y,width,height};
+
+            if(compareState(m_data.gl_viewport,rect)) {
+                KS_GL_STATS_FILTERED(Viewport);
+                return;
+            }
+
+            glViewport(x,y,width,height);
+            KS_CHECK_GL_ERROR(m_log_prefix+"set viewport");
+            KS_GL_STATS_ISSUED(Viewport);
+            setState(m_data.gl_viewport,rect);
+        }
+
+        void StateSet::SetColorMask(GLboolean r,GLboolean g,GLboolean b,GLboolean a)
+        {
+            ColorMask mask{r,g,b,a};
+
+            if(compareState(m_data.gl_color_writemask,mask)) {
+                KS_GL_STATS_FILTERED(ColorMask);
+                return;
+            }
+
+            glColorMask(r,g,b,a);
+            KS_CHECK_GL_ERROR(m_log_prefix+"set color mask");
+            KS_GL_STATS_ISSUED(ColorMask);
+            setState(m_data.gl_color_writemask,mask);
+        }
+
+        void StateSet::SetLineWidth(GLfloat width)
+        {
+            if(compareState(m_data.gl_line_width,width)) {
+                KS_GL_STATS_FILTERED(Raster);
+                return;
+            }
+
+            glLineWidth(width);
+            KS_CHECK_GL_ERROR(m_log_prefix+"set line width");
+            KS_GL_STATS_ISSUED(Raster);
+            setState(m_data.gl_line_width,width);
+        }
+
+        void StateSet::SetDither(GLboolean enabled)
+        {
+            if(compareState(m_data.gl_dither,enabled)) {
+                KS_GL_STATS_FILTERED(Raster);
+                return;
+            }
+
+            if(enabled == GL_TRUE) {
+                glEnable(GL_DITHER);
+            }
+            else {
+                glDisable(GL_DITHER);
+            }
+            KS_CHECK_GL_ERROR(m_log_prefix+"set dither");
+            KS_GL_STATS_ISSUED(Raster);
+
+            setState(m_data.gl_dither,enabled);
+        }
+
         void StateSet::SetBlend(GLboolean enabled)
         {
             if(compareState(m_data.gl_blend,enabled)) {
+                KS_GL_STATS_FILTERED(Blend);
                 return;
             }
 
@@ -250,6 +832,7 @@ namespace ks
                 glDisable(GL_BLEND);
             }
             KS_CHECK_GL_ERROR(m_log_prefix+"set blending");
+            KS_GL_STATS_ISSUED(Blend);
 
             setState(m_data.gl_blend,enabled);
         }
@@ -265,11 +848,15 @@ namespace ks
             if(!same_state) {
                 glBlendFuncSeparate(srcRGB,dstRGB,srcAlpha,dstAlpha);
                 KS_CHECK_GL_ERROR(m_log_prefix+"set blend func");
+                KS_GL_STATS_ISSUED(Blend);
                 setState(m_data.gl_blend_src_rgb,srcRGB);
                 setState(m_data.gl_blend_dst_rgb,dstRGB);
                 setState(m_data.gl_blend_src_alpha,srcAlpha);
                 setState(m_data.gl_blend_dst_alpha,dstAlpha);
             }
+            else {
+                KS_GL_STATS_FILTERED(Blend);
+            }
         }
 
         void StateSet::SetBlendEquation(GLenum modeRGB,GLenum modeAlpha)
@@ -281,15 +868,20 @@ namespace ks
             if(!same_state) {
                 glBlendEquationSeparate(modeRGB,modeAlpha);
                 KS_CHECK_GL_ERROR(m_log_prefix+"set blend equation");
+                KS_GL_STATS_ISSUED(Blend);
                 setState(m_data.gl_blend_equation_rgb,modeRGB);
                 setState(m_data.gl_blend_equation_alpha,modeAlpha);
             }
+            else {
+                KS_GL_STATS_FILTERED(Blend);
+            }
         }
 
 
         void StateSet::SetDepthTest(GLboolean enabled)
         {
             if(compareState(m_data.gl_depth_test,enabled)) {
+                KS_GL_STATS_FILTERED(Depth);
                 return;
             }
 
@@ -300,6 +892,7 @@ namespace ks
                 glDisable(GL_DEPTH_TEST);
             }
             KS_CHECK_GL_ERROR(m_log_prefix+"set depth test");
+            KS_GL_STATS_ISSUED(Depth);
 
             setState(m_data.gl_depth_test,enabled);
         }
@@ -307,11 +900,13 @@ namespace ks
         void StateSet::SetDepthMask(GLboolean enabled)
         {
             if(compareState(m_data.gl_depth_writemask,enabled)) {
+                KS_GL_STATS_FILTERED(Depth);
                 return;
             }
 
             glDepthMask(enabled);
             KS_CHECK_GL_ERROR(m_log_prefix+"set depth writemask");
+            KS_GL_STATS_ISSUED(Depth);
 
             setState(m_data.gl_depth_writemask,enabled);
         }
@@ -319,11 +914,13 @@ namespace ks
         void StateSet::SetDepthFunction(GLenum func)
         {
             if(compareState(m_data.gl_depth_func,func)) {
+                KS_GL_STATS_FILTERED(Depth);
                 return;
             }
 
             glDepthFunc(func);
             KS_CHECK_GL_ERROR(m_log_prefix+"set depth writemask");
+            KS_GL_STATS_ISSUED(Depth);
 
             setState(m_data.gl_depth_func,func);
         }
@@ -337,14 +934,19 @@ namespace ks
             if(!same_state) {
                 glDepthRangef(near,far);
                 KS_CHECK_GL_ERROR(m_log_prefix+"set depth range");
+                KS_GL_STATS_ISSUED(Depth);
                 setState(m_data.gl_depth_range_near,near);
                 setState(m_data.gl_depth_range_far,far);
             }
+            else {
+                KS_GL_STATS_FILTERED(Depth);
+            }
         }
 
         void StateSet::SetStencilTest(GLboolean status)
         {
             if(compareState(m_data.gl_stencil_test,status)) {
+                KS_GL_STATS_FILTERED(Stencil);
                 return;
             }
 
@@ -355,6 +957,7 @@ namespace ks
                 glDisable(GL_STENCIL_TEST);
             }
             KS_CHECK_GL_ERROR(m_log_prefix+"set stencil test");
+            KS_GL_STATS_ISSUED(Stencil);
 
             setState(m_data.gl_stencil_test,status);
         }
@@ -368,16 +971,24 @@ namespace ks
                 if(!compareState(m_data.gl_stencil_writemask,mask)) {
                     glStencilMaskSeparate(face,mask);
                     KS_CHECK_GL_ERROR(m_log_prefix+"glStencilMaskSeparate front");
+                    KS_GL_STATS_ISSUED(Stencil);
                     setState(m_data.gl_stencil_writemask,mask);
                 }
+                else {
+                    KS_GL_STATS_FILTERED(Stencil);
+                }
             }
 
             if(back) {
                 if(!compareState(m_data.gl_stencil_back_writemask,mask)) {
                     glStencilMaskSeparate(face,mask);
                     KS_CHECK_GL_ERROR(m_log_prefix+"glStencilMaskSeparate front");
+                    KS_GL_STATS_ISSUED(Stencil);
                     setState(m_data.gl_stencil_back_writemask,mask);
                 }
+                else {
+                    KS_GL_STATS_FILTERED(Stencil);
+                }
             }
         }
 
@@ -395,10 +1006,14 @@ namespace ks
                 if(!same_state) {
                     glStencilFuncSeparate(face,func,ref,mask);
                     KS_CHECK_GL_ERROR(m_log_prefix+"glStencilFuncSeparate front");
+                    KS_GL_STATS_ISSUED(Stencil);
                     setState(m_data.gl_stencil_func,func);
                     setState(m_data.gl_stencil_value_mask,mask);
                     setState(m_data.gl_stencil_ref,ref);
                 }
+                else {
+                    KS_GL_STATS_FILTERED(Stencil);
+                }
             }
 
             if(back) {
@@ -410,10 +1025,14 @@ namespace ks
                 if(!same_state) {
                     glStencilFuncSeparate(face,func,ref,mask);
                     KS_CHECK_GL_ERROR(m_log_prefix+"glStencilFuncSeparate back");
+                    KS_GL_STATS_ISSUED(Stencil);
                     setState(m_data.gl_stencil_back_func,func);
                     setState(m_data.gl_stencil_back_value_mask,mask);
                     setState(m_data.gl_stencil_back_ref,ref);
                 }
+                else {
+                    KS_GL_STATS_FILTERED(Stencil);
+                }
             }
         }
 
@@ -431,10 +1050,14 @@ namespace ks
                 if(!same_state) {
                     glStencilOpSeparate(face,sfail,dpfail,dppass);
                     KS_CHECK_GL_ERROR(m_log_prefix+"glStencilOpSeparate front");
+                    KS_GL_STATS_ISSUED(Stencil);
                     setState(m_data.gl_stencil_fail,sfail);
                     setState(m_data.gl_stencil_pass_depth_pass,dppass);
                     setState(m_data.gl_stencil_pass_depth_fail,dpfail);
                 }
+                else {
+                    KS_GL_STATS_FILTERED(Stencil);
+                }
             }
 
             if(back) {
@@ -446,16 +1069,21 @@ namespace ks
                 if(!same_state) {
                     glStencilOpSeparate(face,sfail,dpfail,dppass);
                     KS_CHECK_GL_ERROR(m_log_prefix+"glStencilOpSeparate back");
+                    KS_GL_STATS_ISSUED(Stencil);
                     setState(m_data.gl_stencil_back_fail,sfail);
                     setState(m_data.gl_stencil_back_pass_depth_pass,dppass);
                     setState(m_data.gl_stencil_back_pass_depth_fail,dpfail);
                 }
+                else {
+                    KS_GL_STATS_FILTERED(Stencil);
+                }
             }
         }
 
         void StateSet::SetFaceCulling(GLboolean enabled)
         {
             if(compareState(m_data.gl_cull_face,enabled)) {
+                KS_GL_STATS_FILTERED(Cull);
                 return;
             }
 
@@ -466,6 +1094,7 @@ namespace ks
                 glDisable(GL_CULL_FACE);
             }
             KS_CHECK_GL_ERROR(m_log_prefix+"set face culling");
+            KS_GL_STATS_ISSUED(Cull);
 
             setState(m_data.gl_cull_face,enabled);
         }
@@ -473,39 +1102,59 @@ namespace ks
         void StateSet::SetFaceCullingMode(GLenum mode)
         {
             if(compareState(m_data.gl_cull_face_mode,mode)) {
+                KS_GL_STATS_FILTERED(Cull);
                 return;
             }
 
             glCullFace(mode);
             KS_CHECK_GL_ERROR(m_log_prefix+"set face culling mode");
+            KS_GL_STATS_ISSUED(Cull);
             setState(m_data.gl_cull_face_mode,mode);
         }
 
         void StateSet::SetPixelUnpackAlignment(GLint alignment)
         {
             if(compareState(m_data.gl_unpack_alignment,alignment)) {
+                KS_GL_STATS_FILTERED(PixelStore);
                 return;
             }
 
             glPixelStorei(GL_UNPACK_ALIGNMENT,alignment);
             KS_CHECK_GL_ERROR(m_log_prefix+"set pixel unpack alignment");
+            KS_GL_STATS_ISSUED(PixelStore);
             setState(m_data.gl_unpack_alignment,alignment);
         }
 
         void StateSet::SetPixelPackAlignment(GLint alignment)
         {
             if(compareState(m_data.gl_pack_alignment,alignment)) {
+                KS_GL_STATS_FILTERED(PixelStore);
                 return;
             }
 
             glPixelStorei(GL_PACK_ALIGNMENT,alignment);
             KS_CHECK_GL_ERROR(m_log_prefix+"set pixel pack alignment");
+            KS_GL_STATS_ISSUED(PixelStore);
             setState(m_data.gl_pack_alignment,alignment);
         }
 
+        void StateSet::SetPixelUnpackRowLength(GLint row_length)
+        {
+            if(compareState(m_data.gl_unpack_row_length,row_length)) {
+                KS_GL_STATS_FILTERED(PixelStore);
+                return;
+            }
+
+            glPixelStorei(GL_UNPACK_ROW_LENGTH,row_length);
+            KS_CHECK_GL_ERROR(m_log_prefix+"set pixel unpack row length");
+            KS_GL_STATS_ISSUED(PixelStore);
+            setState(m_data.gl_unpack_row_length,row_length);
+        }
+
         void StateSet::SetPolygonOffsetFill(GLboolean enabled)
         {
             if(compareState(m_data.gl_polygon_offset_fill,enabled)) {
+                KS_GL_STATS_FILTERED(PolygonOffset);
                 return;
             }
 
@@ -516,6 +1165,7 @@ namespace ks
                 glDisable(GL_POLYGON_OFFSET_FILL);
             }
             KS_CHECK_GL_ERROR(m_log_prefix+"set polygon offset fill");
+            KS_GL_STATS_ISSUED(PolygonOffset);
 
             setState(m_data.gl_polygon_offset_fill,enabled);
         }
@@ -529,9 +1179,13 @@ namespace ks
             if(!same_state) {
                 glPolygonOffset(factor,units);
                 KS_CHECK_GL_ERROR(m_log_prefix+"set polygon offset");
+                KS_GL_STATS_ISSUED(PolygonOffset);
                 setState(m_data.gl_polygon_offset_factor,factor);
                 setState(m_data.gl_polygon_offset_units,units);
             }
+            else {
+                KS_GL_STATS_FILTERED(PolygonOffset);
+            }
         }
 
         void StateSet::SetClearColor(GLfloat r,GLfloat g,GLfloat b,GLfloat a)
@@ -539,33 +1193,39 @@ namespace ks
             Color color{r,g,b,a};
 
             if(compareState(m_data.gl_color_clear_value,color)) {
+                KS_GL_STATS_FILTERED(Clear);
                 return;
             }
 
             glClearColor(r,g,b,a);
             KS_CHECK_GL_ERROR(m_log_prefix+"set clear color");
+            KS_GL_STATS_ISSUED(Clear);
             setState(m_data.gl_color_clear_value,color);
         }
 
         void StateSet::SetClearDepth(GLfloat depth)
         {
             if(compareState(m_data.gl_depth_clear_value,depth)) {
+                KS_GL_STATS_FILTERED(Clear);
                 return;
             }
 
             glClearDepthf(depth);
             KS_CHECK_GL_ERROR(m_log_prefix+"set clear depth");
+            KS_GL_STATS_ISSUED(Clear);
             setState(m_data.gl_depth_clear_value,depth);
         }
 
         void StateSet::SetClearStencil(GLint s)
         {
             if(compareState(m_data.gl_stencil_clear_value,s)) {
+                KS_GL_STATS_FILTERED(Clear);
                 return;
             }
 
             glClearStencil(s);
             KS_CHECK_GL_ERROR(m_log_prefix+"set clear stencil");
+            KS_GL_STATS_ISSUED(Clear);
             setState(m_data.gl_stencil_clear_value,s);
         }
     }
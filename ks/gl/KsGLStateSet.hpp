@@ -19,6 +19,7 @@
 #define KS_GL_STATE_SET_HPP
 
 // stl
+#include <cstdint>
 #include <vector>
 #include <unordered_set>
 
@@ -39,18 +40,151 @@ namespace ks
                 T value;
             };
 
-            void CaptureState();
+            // Window coordinate rectangle used for
+            // the viewport and scissor box
+            struct Rect
+            {
+                GLint x;
+                GLint y;
+                GLsizei width;
+                GLsizei height;
+
+                bool operator == (Rect const &other) const {
+                    return (x == other.x &&
+                            y == other.y &&
+                            width == other.width &&
+                            height == other.height);
+                }
+            };
+
+            // Categories of state that can be captured or
+            // invalidated independently
+            struct Category
+            {
+                static u32 const FrameBuffer    = 1 << 0;
+                static u32 const Program        = 1 << 1;
+                static u32 const Buffers        = 1 << 2;
+                static u32 const VertexAttribs  = 1 << 3;
+                static u32 const Textures       = 1 << 4;
+                static u32 const Viewport       = 1 << 5;
+                static u32 const Scissor        = 1 << 6;
+                static u32 const ColorMask      = 1 << 7;
+                static u32 const Raster         = 1 << 8;
+                static u32 const Blend          = 1 << 9;
+                static u32 const Depth          = 1 << 10;
+                static u32 const Stencil        = 1 << 11;
+                static u32 const Cull           = 1 << 12;
+                static u32 const PixelStore     = 1 << 13;
+                static u32 const PolygonOffset  = 1 << 14;
+                static u32 const Clear          = 1 << 15;
+                static u32 const All            = 0xFFFFFFFF;
+            };
+
+            // Cost of the last call to CaptureState
+            // * glGet costs vary a lot between drivers, so this
+            //   should be checked on each target device
+            struct CaptureStats
+            {
+                u32 categories{0};
+                uint gl_get_count{0};
+                u64 duration_ns{0};
+            };
+
+            // * Queries the current state of the given categories
+            //   from GL. Each query is a glGet call which may stall
+            //   the pipeline on some drivers
+            void CaptureState(u32 categories=Category::All);
 
-            void SetStateInvalid();
+            // * Marks the given categories as unknown without
+            //   making any GL calls; the next Set call for each
+            //   invalidated state is always issued
+            // * This is the cheaper alternative to CaptureState
+            //   after foreign GL code has run, particularly when
+            //   only the categories it touched are invalidated
+            void SetStateInvalid(u32 categories=Category::All);
+
+            CaptureStats const & GetCaptureStats() const
+            {
+                return m_capture_stats;
+            }
 
             void SetFrameBuffer(GLint fb_handle);
 
+            // * Should be called before a framebuffer that may have
+            //   been bound through this StateSet is deleted; GL
+            //   resets the binding to 0 and the handle may be reused
+            void SetFrameBufferDeleted(GLint fb_handle);
+
+            // program and buffer bindings
+            void SetProgram(GLint prog_handle);
+            void SetBuffer(GLenum target,GLint buff_handle);
+
+            // * Should be called before a buffer that may have been
+            //   bound through this StateSet is deleted; GL resets
+            //   the binding to 0 and the handle may be reused
+            void SetBufferDeleted(GLint buff_handle);
+
             void SetVertexAttributeEnabled(GLuint location,bool enabled);
 
+            // * Skips glVertexAttribPointer if the pointer for
+            //   @location is already set up the same way from the
+            //   currently bound array buffer
+            // * Vertex attribute pointers aren't captured by
+            //   CaptureState; they're invalid until first set
+            void SetVertexAttribPointer(GLuint location,
+                                        GLint size,
+                                        GLenum type,
+                                        GLboolean normalized,
+                                        GLsizei stride,
+                                        std::uintptr_t offset);
+
             void SetActiveTexUnitAndBind(GLint unit,GLint handle,GLenum target,u64 uid);
 
+            // Texture unit allocation
+            struct TextureDesc
+            {
+                GLint handle;
+                GLenum target;
+                u64 uid;
+            };
+
+            // * Returns the texture unit that @uid is bound to. If it
+            //   isn't bound to any unit, it's bound to the least
+            //   recently used unit. No GL calls are made if the
+            //   texture is already resident on some unit, so the
+            //   returned unit isn't necessarily the active one
+            GLint AllocTexUnitAndBind(GLint handle,GLenum target,u64 uid);
+
+            // * Same as above for a set of textures used by a single
+            //   draw call; the textures in the set never evict each
+            //   other. The unit for list_textures[i] is written to
+            //   list_tex_units[i] (ie for sampler uniforms)
+            // * Returns false if there are more textures than units
+            bool AllocTexUnitsAndBind(std::vector<TextureDesc> const &list_textures,
+                                      std::vector<GLint> &list_tex_units);
+
+            // viewport
+            void SetViewport(GLint x,GLint y,GLsizei width,GLsizei height);
+
             // scissor
             void SetScissorTest(GLboolean enabled);
+            void SetScissor(GLint x,GLint y,GLsizei width,GLsizei height);
+
+            // * Enables the scissor test and sets the scissor box to
+            //   the intersection of the given rect and the rect on
+            //   top of the scissor stack (for nested clip regions)
+            // * PopScissor restores the previous rect; popping the
+            //   last rect restores the scissor test and box that
+            //   were set before the first push
+            void PushScissor(GLint x,GLint y,GLsizei width,GLsizei height);
+            void PopScissor();
+
+            // color mask
+            void SetColorMask(GLboolean r,GLboolean g,GLboolean b,GLboolean a);
+
+            // rasterization
+            void SetLineWidth(GLfloat width);
+            void SetDither(GLboolean enabled);
 
             // blending
             void SetBlend(GLboolean enabled);
@@ -77,6 +211,10 @@ namespace ks
             void SetPixelUnpackAlignment(GLint alignment);
             void SetPixelPackAlignment(GLint alignment);
 
+            // * 0 means rows are as long as the upload width
+            // * Only if Implementation::GetUnpackRowLengthSupported
+            void SetPixelUnpackRowLength(GLint row_length);
+
             // polygon offset
             void SetPolygonOffsetFill(GLboolean enabled);
             void SetPolygonOffset(GLfloat factor,GLfloat units);
@@ -100,14 +238,49 @@ namespace ks
                 return m_data.gl_pack_alignment.value;
             }
 
+            GLint GetPixelUnpackRowLength() const
+            {
+                return m_data.gl_unpack_row_length.value;
+            }
+
             State<GLint> GetCurrentFramebuffer() const
             {
                 return m_data.gl_framebuffer_binding;
             }
 
+            State<Rect> GetViewport() const
+            {
+                return m_data.gl_viewport;
+            }
+
+            State<Rect> GetScissor() const
+            {
+                return m_data.gl_scissor_box;
+            }
+
+            State<GLint> GetCurrentProgram() const
+            {
+                return m_data.gl_current_program;
+            }
+
+            State<GLint> GetCurrentArrayBuffer() const
+            {
+                return m_data.gl_array_buffer_binding;
+            }
+
+            State<GLint> GetCurrentElementArrayBuffer() const
+            {
+                return m_data.gl_element_array_buffer_binding;
+            }
+
             // ============================================================= //
 
         private:
+            void setImplementationLimits();
+
+            GLint findTexUnit(u64 uid) const;
+            GLint findLeastRecentTexUnit(u64 used_after) const;
+
             template<typename T>
             void setState(State<T> &state, T value)
             {
@@ -136,6 +309,40 @@ namespace ks
                 }
             };
 
+            struct VertexAttribPointer
+            {
+                GLint buffer;
+                GLint size;
+                GLenum type;
+                GLboolean normalized;
+                GLsizei stride;
+                std::uintptr_t offset;
+
+                bool operator == (VertexAttribPointer const &other) {
+                    return (buffer == other.buffer &&
+                            size == other.size &&
+                            type == other.type &&
+                            normalized == other.normalized &&
+                            stride == other.stride &&
+                            offset == other.offset);
+                }
+            };
+
+            struct ColorMask
+            {
+                GLboolean r;
+                GLboolean g;
+                GLboolean b;
+                GLboolean a;
+
+                bool operator == (ColorMask const &other) {
+                    return (r == other.r &&
+                            g == other.g &&
+                            b == other.b &&
+                            a == other.a);
+                }
+            };
+
 
             std::string m_log_prefix{"StateSet: "};
 
@@ -148,7 +355,14 @@ namespace ks
 
                 // ============================================================= //
 
+                State<GLint> gl_current_program;
+                State<GLint> gl_array_buffer_binding;
+                State<GLint> gl_element_array_buffer_binding;
+
+                // ============================================================= //
+
                 std::vector<State<bool>> gl_vertex_attrib_array_enabled;
+                std::vector<State<VertexAttribPointer>> list_vertex_attrib_pointers;
 
                 // ============================================================= //
 
@@ -166,18 +380,36 @@ namespace ks
                 //   are NOT OpenGL texture handles.
                 // * The list index denotes the corresponding
                 //   texture unit; list_[0] == texture unit 0
+                // * last_used is a timestamp from m_tex_unit_clock
+                //   used to find the least recently used unit
                 struct TextureBindingState {
                     bool valid;
                     uint64_t uid; // this is NOT an opengl texture handle
+                    u64 last_used;
                     TextureBindingState() :
-                        valid(false) {}
+                        valid(false),
+                        last_used(0) {}
                 };
                 std::vector<TextureBindingState> list_texture_bindstates;
 
                 // ============================================================= //
 
+                State<Rect> gl_viewport;
+
+                // ============================================================= //
+
                 // (scissor)
                 State<GLboolean> gl_scissor_test;
+                State<Rect> gl_scissor_box;
+
+                // ============================================================= //
+
+                State<ColorMask> gl_color_writemask;
+
+                // ============================================================= //
+
+                State<GLfloat> gl_line_width;
+                State<GLboolean> gl_dither;
 
                 // ============================================================= //
 
@@ -237,6 +469,10 @@ namespace ks
                 State<GLint> gl_pack_alignment;
                 State<GLint> gl_unpack_alignment;
 
+                // GL_UNPACK_ROW_LENGTH, the source row pitch in pixels
+                // for uploads (GL_EXT_unpack_subimage on GL ES 2)
+                State<GLint> gl_unpack_row_length;
+
                 // ============================================================= //
 
                 State<GLboolean> gl_polygon_offset_fill;
@@ -251,6 +487,19 @@ namespace ks
             };
 
             Data m_data;
+
+            CaptureStats m_capture_stats;
+
+            // incremented every time a texture unit is used
+            u64 m_tex_unit_clock{0};
+
+            // * Stack of clip rects used by PushScissor/PopScissor;
+            //   this isn't GL state so it's kept outside of m_data
+            // * The scissor test and box that were set before the
+            //   first push are restored when the stack is emptied
+            std::vector<Rect> m_list_scissor_rects;
+            State<GLboolean> m_scissor_test_before_push;
+            State<Rect> m_scissor_box_before_push;
         };
     }
 } // namespace ks
@@ -0,0 +1,133 @@
+/*
+   Copyright (C) 2015 Preet Desai (preet.desai@gmail.com)
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#include <ks/gl/KsGLStats.hpp>
+
+namespace ks
+{
+    namespace gl
+    {
+        namespace Stats
+        {
+            namespace {
+                Snapshot g_current_frame;
+
+                // labels of the active Scopes, innermost last
+                std::vector<char const *> g_list_scope_labels;
+
+                char const * const g_list_category_names[] = {
+                    "FrameBuffer",
+                    "Program",
+                    "Buffer",
+                    "VertexAttrib",
+                    "Texture",
+                    "Viewport",
+                    "Scissor",
+                    "ColorMask",
+                    "Raster",
+                    "Blend",
+                    "Depth",
+                    "Stencil",
+                    "Cull",
+                    "PixelStore",
+                    "PolygonOffset",
+                    "Clear",
+                    "Uniform",
+                    "BufferUpload",
+                    "TextureUpload",
+                    "Draw"
+                };
+
+                static_assert(sizeof(g_list_category_names)/sizeof(char const*) ==
+                              static_cast<size_t>(Category::Count),
+                              "Stats: missing category name");
+
+                // Returns the counter for @category under the
+                // innermost Scope's label, or nullptr if there
+                // isn't an active Scope
+                Counter * getLabelCounter(Category category)
+                {
+                    if(g_list_scope_labels.empty()) {
+                        return nullptr;
+                    }
+
+                    char const * label = g_list_scope_labels.back();
+                    auto &list_labels = g_current_frame.list_labels;
+
+                    // Few labels are expected, so search linearly
+                    for(auto &label_counters : list_labels) {
+                        if(label_counters.label == label) {
+                            return &(label_counters.list_counters[
+                                     static_cast<size_t>(category)]);
+                        }
+                    }
+
+                    list_labels.push_back(LabelCounters{label,CounterList()});
+                    return &(list_labels.back().list_counters[
+                             static_cast<size_t>(category)]);
+                }
+            }
+
+            Scope::Scope(char const * label)
+            {
+                g_list_scope_labels.push_back(label);
+            }
+
+            Scope::~Scope()
+            {
+                g_list_scope_labels.pop_back();
+            }
+
+            void AddIssued(Category category)
+            {
+                g_current_frame.list_counters[static_cast<size_t>(category)].issued++;
+
+                if(Counter * counter = getLabelCounter(category)) {
+                    counter->issued++;
+                }
+            }
+
+            void AddFiltered(Category category)
+            {
+                g_current_frame.list_counters[static_cast<size_t>(category)].filtered++;
+
+                if(Counter * counter = getLabelCounter(category)) {
+                    counter->filtered++;
+                }
+            }
+
+            Snapshot EndFrame()
+            {
+                Snapshot snapshot = g_current_frame;
+
+                g_current_frame = Snapshot();
+                g_current_frame.frame = snapshot.frame+1;
+
+                return snapshot;
+            }
+
+            Snapshot const & GetCurrentFrame()
+            {
+                return g_current_frame;
+            }
+
+            char const * GetCategoryName(Category category)
+            {
+                return g_list_category_names[static_cast<size_t>(category)];
+            }
+        }
+    }
+}
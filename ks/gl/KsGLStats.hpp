@@ -0,0 +1,140 @@
+/*
+   Copyright (C) 2015 Preet Desai (preet.desai@gmail.com)
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#ifndef KS_GL_STATS_HPP
+#define KS_GL_STATS_HPP
+
+// stl
+#include <array>
+#include <vector>
+
+// ks
+#include <ks/KsGlobal.hpp>
+
+namespace ks
+{
+    namespace gl
+    {
+        // Counters for GL calls that were issued and calls that
+        // were filtered out as redundant (by the StateSet)
+        // * Counting is only done if KS_GL_STATS is defined; the
+        //   KS_GL_STATS_ macros compile to nothing otherwise
+        // * Calls made within a Scope are also counted against
+        //   the innermost Scope's label, to find which call sites
+        //   cause churn
+        // * Must only be called from the rendering thread
+        namespace Stats
+        {
+            enum class Category : u8
+            {
+                FrameBuffer = 0,
+                Program,
+                Buffer,
+                VertexAttrib,
+                Texture,
+                Viewport,
+                Scissor,
+                ColorMask,
+                Raster,
+                Blend,
+                Depth,
+                Stencil,
+                Cull,
+                PixelStore,
+                PolygonOffset,
+                Clear,
+                Uniform,
+                BufferUpload,
+                TextureUpload,
+                Draw,
+                Count
+            };
+
+            struct Counter
+            {
+                u32 issued{0};
+                u32 filtered{0};
+
+                u32 GetTotal() const
+                {
+                    return issued+filtered;
+                }
+            };
+
+            using CounterList =
+                std::array<Counter,static_cast<size_t>(Category::Count)>;
+
+            struct LabelCounters
+            {
+                char const * label;
+                CounterList list_counters;
+            };
+
+            struct Snapshot
+            {
+                u64 frame{0};
+                CounterList list_counters;
+
+                // * One entry per Scope label that was
+                //   active when a call was counted
+                std::vector<LabelCounters> list_labels;
+
+                Counter const & Get(Category category) const
+                {
+                    return list_counters[static_cast<size_t>(category)];
+                }
+            };
+
+            // * Attributes calls counted during its lifetime to
+            //   @label, which must be a string literal (labels
+            //   are compared by address)
+            class Scope final
+            {
+            public:
+                Scope(char const * label);
+                ~Scope();
+
+                Scope(Scope const &) = delete;
+                Scope & operator = (Scope const &) = delete;
+            };
+
+            void AddIssued(Category category);
+            void AddFiltered(Category category);
+
+            // * Returns the counters for the current frame,
+            //   then resets them and advances the frame
+            Snapshot EndFrame();
+
+            // * Returns the counters for the current
+            //   (incomplete) frame without resetting them
+            Snapshot const & GetCurrentFrame();
+
+            char const * GetCategoryName(Category category);
+        }
+    }
+}
+
+#ifdef KS_GL_STATS
+#define KS_GL_STATS_ISSUED(x) ks::gl::Stats::AddIssued(ks::gl::Stats::Category::x)
+#define KS_GL_STATS_FILTERED(x) ks::gl::Stats::AddFiltered(ks::gl::Stats::Category::x)
+#define KS_GL_STATS_SCOPE(label) ks::gl::Stats::Scope const ks_gl_stats_scope(label)
+#else
+#define KS_GL_STATS_ISSUED(x)
+#define KS_GL_STATS_FILTERED(x)
+#define KS_GL_STATS_SCOPE(label)
+#endif
+
+#endif // KS_GL_STATS_HPP
@@ -25,7 +25,8 @@ namespace ks
         uint64_t Texture::s_id_count = 0;
 
         Texture::Texture() :
-            m_texture_handle(0)
+            m_texture_handle(0),
+            m_bind_count(0)
         {
             m_log_prefix = "Texture: ";
         }
@@ -75,6 +76,73 @@ namespace ks
             return true;
         }
 
+        u32 Texture::GetBindCount() const
+        {
+            return m_bind_count;
+        }
+
+        GLint Texture::GLAllocUnitAndBind(StateSet* state_set)
+        {
+            if(m_texture_handle == 0) {
+                LOG.Error() << m_log_prefix
+                            << "tried to bind with texture 0";
+                return -1;
+            }
+
+            m_bind_count++;
+
+            return state_set->AllocTexUnitAndBind(
+                        m_texture_handle,this->GetTarget(),m_id);
+        }
+
+        bool Texture::glSetActive(StateSet* state_set)
+        {
+            if(m_texture_handle == 0) {
+                LOG.Error() << m_log_prefix
+                            << "tried to bind with texture 0";
+                return false;
+            }
+
+            // Not a use, so the bind count is left alone
+            GLint const unit = state_set->AllocTexUnitAndBind(
+                        m_texture_handle,this->GetTarget(),m_id);
+
+            // A resident texture's unit isn't made active
+            // by the allocation
+            state_set->SetActiveTexUnitAndBind(
+                        unit,m_texture_handle,this->GetTarget(),m_id);
+
+            return true;
+        }
+
+        bool Texture::GLAllocUnitsAndBind(StateSet* state_set,
+                                          std::vector<Texture*> const &list_textures,
+                                          std::vector<GLint> &list_tex_units)
+        {
+            std::vector<StateSet::TextureDesc> list_tex_descs;
+            list_tex_descs.reserve(list_textures.size());
+
+            for(Texture* texture : list_textures) {
+                if(texture->m_texture_handle == 0) {
+                    LOG.Error() << texture->m_log_prefix
+                                << "tried to bind with texture 0";
+                    return false;
+                }
+
+                list_tex_descs.push_back(
+                            StateSet::TextureDesc{
+                                static_cast<GLint>(texture->m_texture_handle),
+                                texture->GetTarget(),
+                                texture->m_id});
+            }
+
+            for(Texture* texture : list_textures) {
+                texture->m_bind_count++;
+            }
+
+            return state_set->AllocTexUnitsAndBind(list_tex_descs,list_tex_units);
+        }
+
         void Texture::GLCleanUp()
         {
             if(!(m_texture_handle == 0)) {
@@ -20,6 +20,7 @@
 
 // stl
 #include <memory>
+#include <vector>
 
 // ks
 #include <ks/gl/KsGLStateSet.hpp>
@@ -32,9 +33,16 @@ namespace ks
         class Texture : public Resource
         {
         public:
+            // * The mipmap filters are only valid for minification
+            //   and need every mipmap level to be specified, either
+            //   uploaded or generated
             enum class Filter : GLenum {
                 Linear = GL_LINEAR,
-                Nearest = GL_NEAREST
+                Nearest = GL_NEAREST,
+                NearestMipmapNearest = GL_NEAREST_MIPMAP_NEAREST,
+                LinearMipmapNearest = GL_LINEAR_MIPMAP_NEAREST,
+                NearestMipmapLinear = GL_NEAREST_MIPMAP_LINEAR,
+                LinearMipmapLinear = GL_LINEAR_MIPMAP_LINEAR // trilinear
             };
 
             enum class Wrap : GLenum {
@@ -51,18 +59,46 @@ namespace ks
 
             virtual bool GLInit();
 
+            virtual GLenum GetTarget() const = 0;
+
             virtual bool GLBind(StateSet* state_set,
                                 GLuint tex_unit) = 0;
 
+            // * Incremented whenever the texture is bound for use
+            //   (GLBind and the GLAllocUnit calls), so a caller can
+            //   tell whether it was used since it last checked
+            // * Binds made internally to upload data aren't counted
+            u32 GetBindCount() const;
+
+            // * Binds this texture to whichever texture unit the
+            //   StateSet allocates; a unit this texture is already
+            //   bound to is reused if possible
+            // * The returned unit isn't necessarily the active one
+            // * Returns the texture unit or -1 on failure
+            GLint GLAllocUnitAndBind(StateSet* state_set);
+
+            // * Binds a set of textures for a single draw call,
+            //   writing the texture unit for list_textures[i]
+            //   to list_tex_units[i]
+            static bool GLAllocUnitsAndBind(StateSet* state_set,
+                                            std::vector<Texture*> const &list_textures,
+                                            std::vector<GLint> &list_tex_units);
+
             virtual void GLUnbind() = 0;
 
             virtual void GLCleanUp();
 
         protected:
+            // * Makes the unit this texture is bound to active,
+            //   allocating one if it isn't bound, so that calls
+            //   on the texture target affect this texture
+            bool glSetActive(StateSet* state_set);
+
             std::string m_log_prefix;
             u64 m_id;
 
             GLuint m_texture_handle;
+            u32 m_bind_count;
 
         private:
             static u64 s_id_count;
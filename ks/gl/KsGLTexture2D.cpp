@@ -17,23 +17,251 @@
 #include <ks/gl/KsGLTexture2D.hpp>
 #include <ks/gl/KsGLStateSet.hpp>
 #include <ks/gl/KsGLImplementation.hpp>
+#include <ks/gl/KsGLStats.hpp>
+#include <ks/gl/KsGLImageUtils.hpp>
 #include <ks/shared/KsImage.hpp>
 
 #include <algorithm>
+#include <cstring>
+
+// Compressed formats that may be missing from the GL headers
+#ifndef GL_ETC1_RGB8_OES
+#define GL_ETC1_RGB8_OES 0x8D64
+#endif
+
+#ifndef GL_COMPRESSED_RGB_S3TC_DXT1_EXT
+#define GL_COMPRESSED_RGB_S3TC_DXT1_EXT 0x83F0
+#define GL_COMPRESSED_RGBA_S3TC_DXT1_EXT 0x83F1
+#define GL_COMPRESSED_RGBA_S3TC_DXT5_EXT 0x83F3
+#endif
+
+#ifndef GL_COMPRESSED_RGB_PVRTC_4BPPV1_IMG
+#define GL_COMPRESSED_RGB_PVRTC_4BPPV1_IMG 0x8C00
+#define GL_COMPRESSED_RGB_PVRTC_2BPPV1_IMG 0x8C01
+#define GL_COMPRESSED_RGBA_PVRTC_4BPPV1_IMG 0x8C02
+#define GL_COMPRESSED_RGBA_PVRTC_2BPPV1_IMG 0x8C03
+#endif
+
+#ifndef GL_COMPRESSED_RGBA_ASTC_4x4_KHR
+#define GL_COMPRESSED_RGBA_ASTC_4x4_KHR 0x93B0
+#endif
+
+#ifndef GL_COMPRESSED_RGBA_ASTC_8x8_KHR
+#define GL_COMPRESSED_RGBA_ASTC_8x8_KHR 0x93B7
+#endif
 
 namespace ks
 {
     namespace gl
     {
+        namespace
+        {
+            using Format = Texture2D::Format;
+
+            struct CompressedFormatDesc
+            {
+                Format format;
+                GLenum gl_format;
+
+                // size in bytes of a block of texels, and the
+                // smallest number of blocks per dimension
+                u8 block_width;
+                u8 block_height;
+                u8 block_bytes;
+                u8 min_blocks;
+
+                bool sub_image;
+
+                // the format is supported if either extension is
+                char const * ext;
+                char const * ext_alt;
+            };
+
+            CompressedFormatDesc const g_list_compressed_formats[] = {
+                { Format::ETC1_RGB8, GL_ETC1_RGB8_OES,
+                  4,4,8,1,false,
+                  "GL_OES_compressed_ETC1_RGB8_texture",nullptr },
+
+                { Format::DXT1_RGB, GL_COMPRESSED_RGB_S3TC_DXT1_EXT,
+                  4,4,8,1,true,
+                  "GL_EXT_texture_compression_s3tc","GL_EXT_texture_compression_dxt1" },
+
+                { Format::DXT1_RGBA, GL_COMPRESSED_RGBA_S3TC_DXT1_EXT,
+                  4,4,8,1,true,
+                  "GL_EXT_texture_compression_s3tc","GL_EXT_texture_compression_dxt1" },
+
+                { Format::DXT5_RGBA, GL_COMPRESSED_RGBA_S3TC_DXT5_EXT,
+                  4,4,16,1,true,
+                  "GL_EXT_texture_compression_s3tc",nullptr },
+
+                { Format::PVRTC_RGB_4BPP, GL_COMPRESSED_RGB_PVRTC_4BPPV1_IMG,
+                  4,4,8,2,false,
+                  "GL_IMG_texture_compression_pvrtc",nullptr },
+
+                { Format::PVRTC_RGBA_4BPP, GL_COMPRESSED_RGBA_PVRTC_4BPPV1_IMG,
+                  4,4,8,2,false,
+                  "GL_IMG_texture_compression_pvrtc",nullptr },
+
+                { Format::PVRTC_RGB_2BPP, GL_COMPRESSED_RGB_PVRTC_2BPPV1_IMG,
+                  8,4,8,2,false,
+                  "GL_IMG_texture_compression_pvrtc",nullptr },
+
+                { Format::PVRTC_RGBA_2BPP, GL_COMPRESSED_RGBA_PVRTC_2BPPV1_IMG,
+                  8,4,8,2,false,
+                  "GL_IMG_texture_compression_pvrtc",nullptr },
+
+                { Format::ASTC_4x4_RGBA, GL_COMPRESSED_RGBA_ASTC_4x4_KHR,
+                  4,4,16,1,true,
+                  "GL_KHR_texture_compression_astc_ldr",nullptr },
+
+                { Format::ASTC_8x8_RGBA, GL_COMPRESSED_RGBA_ASTC_8x8_KHR,
+                  8,8,16,1,true,
+                  "GL_KHR_texture_compression_astc_ldr",nullptr }
+            };
+
+            CompressedFormatDesc const * findCompressedFormat(Format format)
+            {
+                for(auto const &desc : g_list_compressed_formats) {
+                    if(desc.format == format) {
+                        return &desc;
+                    }
+                }
+                return nullptr;
+            }
+
+            // GL ES 2 only supports mipmaps for POT textures
+            // unless GL_OES_texture_npot is available
+            bool getMipmapsSupported(u16 width,u16 height)
+            {
+                #ifdef KS_ENV_GL_ES
+                    bool const pot =
+                            ((width & (width-1)) == 0) &&
+                            ((height & (height-1)) == 0);
+
+                    return (pot || Implementation::GetGLExtensionExists(
+                                "GL_OES_texture_npot"));
+                #else
+                    (void)width;
+                    (void)height;
+                    return true;
+                #endif
+            }
+
+            // glGenerateMipmap is core in GL ES 2; desktop GL 2.1
+            // needs GL_ARB_framebuffer_object or the EXT version
+            bool generateMipmap(std::string const &log_prefix)
+            {
+                #if defined(KS_ENV_GL_ES)
+                    glGenerateMipmap(GL_TEXTURE_2D);
+                #elif defined(KS_ENV_GL_DESKTOP)
+                    if(Implementation::GetGLExtensionExists("GL_ARB_framebuffer_object")) {
+                        glGenerateMipmap(GL_TEXTURE_2D);
+                    }
+                    else if(Implementation::GetGLExtensionExists("GL_EXT_framebuffer_object")) {
+                        glGenerateMipmapEXT(GL_TEXTURE_2D);
+                    }
+                    else {
+                        LOG.Error() << log_prefix
+                                    << "glGenerateMipmap N/A, upload "
+                                       "precomputed levels instead";
+                        return false;
+                    }
+                #endif
+
+                KS_CHECK_GL_ERROR(log_prefix+"generate mipmap");
+                return true;
+            }
+
+            struct Rect
+            {
+                u32 x0;
+                u32 y0;
+                u32 x1; // exclusive
+                u32 y1; // exclusive
+            };
+
+            Rect getUpdateRect(Texture2D::Update const &update)
+            {
+                return Rect{
+                    update.src_offset.x,
+                    update.src_offset.y,
+                    update.src_offset.x+update.src_data->width,
+                    update.src_offset.y+update.src_data->height
+                };
+            }
+
+            u32 getArea(Rect const &rect)
+            {
+                return (rect.x1-rect.x0)*(rect.y1-rect.y0);
+            }
+
+            bool getContains(Rect const &a,Rect const &b)
+            {
+                return (a.x0 <= b.x0 && a.y0 <= b.y0 &&
+                        a.x1 >= b.x1 && a.y1 >= b.y1);
+            }
+
+            // * Returns true if the union of @a and @b fills their
+            //   bounding rect exactly, ie. they're adjacent along a
+            //   full edge or one overlaps the other along an axis
+            bool getMergeable(Rect const &a,Rect const &b,Rect &merged)
+            {
+                merged.x0 = std::min(a.x0,b.x0);
+                merged.y0 = std::min(a.y0,b.y0);
+                merged.x1 = std::max(a.x1,b.x1);
+                merged.y1 = std::max(a.y1,b.y1);
+
+                u32 overlap = 0;
+                if(a.x0 < b.x1 && b.x0 < a.x1 && a.y0 < b.y1 && b.y0 < a.y1) {
+                    overlap = getArea(Rect{
+                        std::max(a.x0,b.x0),std::max(a.y0,b.y0),
+                        std::min(a.x1,b.x1),std::min(a.y1,b.y1)});
+                }
+
+                return (getArea(merged) == getArea(a)+getArea(b)-overlap);
+            }
+
+            // * GL pads each source row up to a multiple of the unpack
+            //   alignment; returns an alignment that turns rows of
+            //   @row_bytes_packed into rows of @row_bytes, preferring
+            //   @current to avoid a state change, or 0 if none does
+            GLint getUnpackAlignment(u32 row_bytes_packed,
+                                     u32 row_bytes,
+                                     GLint current)
+            {
+                auto matches = [&](GLint alignment) {
+                    u32 const mask = static_cast<u32>(alignment)-1;
+                    return (((row_bytes_packed+mask) & ~mask) == row_bytes);
+                };
+
+                if((current == 1 || current == 2 || current == 4 || current == 8) &&
+                   matches(current)) {
+                    return current;
+                }
+
+                for(GLint alignment : {8,4,2,1}) {
+                    if(matches(alignment)) {
+                        return alignment;
+                    }
+                }
+
+                return 0;
+            }
+        }
+
+        // ============================================================= //
+
         Texture2D::Texture2D(Format format) :
             m_width(16),
             m_height(16),
             m_format(format),
+            m_compressed(false),
             m_filter_min(Filter::Nearest),
             m_filter_mag(Filter::Nearest),
             m_wrap_s(Wrap::ClampToEdge),
             m_wrap_t(Wrap::ClampToEdge),
-            m_upd_params(true)
+            m_upd_params(true),
+            m_upd_mipmaps(false)
         {
             // save params
             if(m_format == Format::RGB8) {
@@ -106,6 +334,16 @@ namespace ks
                 m_gl_datatype = GL_UNSIGNED_INT_24_8;
                 #endif
             }
+            else if(GetFormatCompressed(m_format)) {
+                if(!GetFormatSupported(m_format)) {
+                    LOG.Error() << m_log_prefix
+                                << "Compressed texture requested but "
+                                << findCompressedFormat(m_format)->ext << " N/A";
+                }
+                m_gl_format = findCompressedFormat(m_format)->gl_format;
+                m_gl_datatype = 0;
+                m_compressed = true;
+            }
 
             // We explicitly set the filtering and wrap modes
             // in the constructor because texturing might not
@@ -121,8 +359,32 @@ namespace ks
             // empty
         }
 
+        GLenum Texture2D::GetTarget() const
+        {
+            return GL_TEXTURE_2D;
+        }
+
+        Texture2D::Format Texture2D::GetFormat() const
+        {
+            return m_format;
+        }
+
+        u32 Texture2D::GetNumBytes() const
+        {
+            u32 const num_bytes = calcNumBytes();
+
+            bool const mipmapped =
+                    (m_filter_min != Filter::Linear) &&
+                    (m_filter_min != Filter::Nearest);
+
+            // the full chain adds about a third
+            return mipmapped ? (num_bytes + num_bytes/3) : num_bytes;
+        }
+
         bool Texture2D::GLBind(StateSet* state_set,GLuint tex_unit)
         {
+            m_bind_count++;
+
             if(m_texture_handle == 0) {
                 LOG.Error() << m_log_prefix
                             << "tried to bind with texture 0";
@@ -145,28 +407,63 @@ namespace ks
             // do nothing
         }
 
-        void Texture2D::GLSync()
+        void Texture2D::GLCleanUp()
+        {
+            Texture::GLCleanUp();
+            m_upd_params = true;
+        }
+
+        void Texture2D::GLSync(StateSet* state_set)
         {
+            if(m_list_updates.empty() && !m_upd_mipmaps && !m_upd_params) {
+                return;
+            }
+
+            if(!glSetActive(state_set)) {
+                return;
+            }
+
+            if(!m_compressed && m_list_updates.size() > 1)
+            {
+                coalesceUpdates();
+            }
+
             for(Update& update : m_list_updates)
             {
-                if((update.options & Update::ReUpload) == Update::ReUpload)
+                if(m_compressed)
                 {
+                    glUploadCompressed(update);
+                }
+                else if((update.options & Update::ReUpload) == Update::ReUpload)
+                {
+                    // Levels above 0 are sized by their source data
+                    u16 const width = (update.mip_level == 0) ?
+                                m_width : update.src_data->width;
+
+                    u16 const height = (update.mip_level == 0) ?
+                                m_height : update.src_data->height;
+
                     if(update.src_data->data_ptr)
                     {
-                        assert(m_width == update.src_data->width);
-                        assert(m_height == update.src_data->height);
+                        assert(width == update.src_data->width);
+                        assert(height == update.src_data->height);
                         assert(0 == update.src_offset.x);
                         assert(0 == update.src_offset.y);
 
+                        void const * data = glSetUnpackState(state_set,update);
+                        if(!data) {
+                            continue;
+                        }
+
                         glTexImage2D(GL_TEXTURE_2D,
-                                     0, // mipmap level
+                                     update.mip_level,
                                      m_gl_format,
-                                     m_width,
-                                     m_height,
+                                     width,
+                                     height,
                                      0, // border, not used for GLES
                                      m_gl_format,
                                      m_gl_datatype,
-                                     update.src_data->data_ptr);
+                                     data);
                     }
                     else
                     {
@@ -175,10 +472,10 @@ namespace ks
                         // be created but image data is unspecified (see
                         // ES 2 spec, 3.7.1 p 69)
                         glTexImage2D(GL_TEXTURE_2D,
-                                     0, // mipmap level
+                                     update.mip_level,
                                      m_gl_format,
-                                     m_width,
-                                     m_height,
+                                     width,
+                                     height,
                                      0, // border, not used for GLES
                                      m_gl_format,
                                      m_gl_datatype,
@@ -186,23 +483,46 @@ namespace ks
                     }
 
                     KS_CHECK_GL_ERROR(m_log_prefix+"upload texture");
+                    KS_GL_STATS_ISSUED(TextureUpload);
                 }
                 else
                 {
+                    void const * data = glSetUnpackState(state_set,update);
+                    if(!data) {
+                        continue;
+                    }
+
                     glTexSubImage2D(GL_TEXTURE_2D,
-                                    0, // mipmap level
+                                    update.mip_level,
                                     update.src_offset.x,
                                     update.src_offset.y,
                                     update.src_data->width,
                                     update.src_data->height,
                                     m_gl_format,
                                     m_gl_datatype,
-                                    update.src_data->data_ptr);
+                                    data);
 
                     KS_CHECK_GL_ERROR(m_log_prefix+"upload subimage");
+                    KS_GL_STATS_ISSUED(TextureUpload);
                 }
             }
 
+            // Generate once for all of the updates
+            if(m_upd_mipmaps)
+            {
+                if(getMipmapsSupported(m_width,m_height)) {
+                    generateMipmap(m_log_prefix);
+                    KS_GL_STATS_ISSUED(TextureUpload);
+                }
+                else {
+                    LOG.Error() << m_log_prefix
+                                << "can't generate mipmaps for NPOT "
+                                   "texture, GL_OES_texture_npot N/A";
+                }
+
+                m_upd_mipmaps = false;
+            }
+
             m_list_updates.clear();
 
 
@@ -229,6 +549,7 @@ namespace ks
                                 static_cast<GLint>(m_wrap_t));
 
                 KS_CHECK_GL_ERROR(m_log_prefix+"texture wrap params");
+                KS_GL_STATS_ISSUED(Texture);
 
                 m_upd_params = false;
             }
@@ -239,7 +560,7 @@ namespace ks
             bool const is_reupload =
                     ((update.options & Update::ReUpload) == Update::ReUpload);
 
-            if(is_reupload)
+            if(is_reupload && (update.mip_level == 0))
             {
                 // Erase all updates before this one
                 m_list_updates.clear();
@@ -249,6 +570,17 @@ namespace ks
                 m_height = update.src_data->height;
             }
 
+            if((update.options & Update::GenerateMipmaps) == Update::GenerateMipmaps) {
+                if(m_compressed) {
+                    LOG.Error() << m_log_prefix
+                                << "can't generate mipmaps for compressed "
+                                   "textures, upload precomputed levels instead";
+                }
+                else {
+                    m_upd_mipmaps = true;
+                }
+            }
+
             m_list_updates.push_back(update);
         }
 
@@ -276,21 +608,355 @@ namespace ks
             return m_upd_params;
         }
 
-        u32 Texture2D::calcNumBytes() const
+        bool Texture2D::GetFormatCompressed(Format format)
         {
-            double num_pixels = m_width*m_height;
+            return (findCompressedFormat(format) != nullptr);
+        }
+
+        bool Texture2D::GetFormatSupported(Format format)
+        {
+            CompressedFormatDesc const * desc = findCompressedFormat(format);
+            if(!desc) {
+                return true;
+            }
+
+            return (Implementation::GetGLExtensionExists(desc->ext) ||
+                    (desc->ext_alt &&
+                     Implementation::GetGLExtensionExists(desc->ext_alt)));
+        }
+
+        bool Texture2D::GetFormatFromGL(GLenum gl_format,
+                                        GLenum gl_datatype,
+                                        Format &format)
+        {
+            if(gl_datatype == 0) {
+                for(auto const &desc : g_list_compressed_formats) {
+                    if(desc.gl_format == gl_format) {
+                        format = desc.format;
+                        return true;
+                    }
+                }
+                return false;
+            }
+
+            if(gl_datatype == GL_UNSIGNED_BYTE) {
+                if(gl_format == GL_RGBA) {
+                    format = Format::RGBA8;
+                    return true;
+                }
+                else if(gl_format == GL_RGB) {
+                    format = Format::RGB8;
+                    return true;
+                }
+                else if(gl_format == GL_LUMINANCE) {
+                    format = Format::LUMINANCE8;
+                    return true;
+                }
+            }
+            else if(gl_datatype == GL_UNSIGNED_SHORT_4_4_4_4 && gl_format == GL_RGBA) {
+                format = Format::RGBA4;
+                return true;
+            }
+            else if(gl_datatype == GL_UNSIGNED_SHORT_5_5_5_1 && gl_format == GL_RGBA) {
+                format = Format::RGB5_A1;
+                return true;
+            }
+            else if(gl_datatype == GL_UNSIGNED_SHORT_5_6_5 && gl_format == GL_RGB) {
+                format = Format::RGB565;
+                return true;
+            }
+
+            return false;
+        }
+
+        u32 Texture2D::CalcNumBytes(Format format,u32 width,u32 height)
+        {
+            CompressedFormatDesc const * desc = findCompressedFormat(format);
+            if(desc) {
+                u32 const blocks_x =
+                        std::max<u32>((width+desc->block_width-1)/desc->block_width,
+                                      desc->min_blocks);
+
+                u32 const blocks_y =
+                        std::max<u32>((height+desc->block_height-1)/desc->block_height,
+                                      desc->min_blocks);
+
+                return blocks_x*blocks_y*desc->block_bytes;
+            }
+
+            double num_pixels = width*height;
             double bpp =
-                    (m_format == Format::RGBA8) ? 4 :
-                    (m_format == Format::RGB8) ? 3 :
-                    (m_format == Format::LUMINANCE8) ? 1 :
-                    (m_format == Format::RGBA4) ? 2 :
-                    (m_format == Format::RGB5_A1) ? 2 :
-                    (m_format == Format::RGB565) ? 2 :
-                    (m_format == Format::DEPTH_COMPONENT16) ? 2 :
-                    (m_format == Format::DEPTH_COMPONENT32) ? 4 :
-                    (m_format == Format::DEPTH24_STENCIL8) ? 4 : 0;
+                    (format == Format::RGBA8) ? 4 :
+                    (format == Format::RGB8) ? 3 :
+                    (format == Format::LUMINANCE8) ? 1 :
+                    (format == Format::RGBA4) ? 2 :
+                    (format == Format::RGB5_A1) ? 2 :
+                    (format == Format::RGB565) ? 2 :
+                    (format == Format::DEPTH_COMPONENT16) ? 2 :
+                    (format == Format::DEPTH_COMPONENT32) ? 4 :
+                    (format == Format::DEPTH24_STENCIL8) ? 4 : 0;
 
             return static_cast<u32>(num_pixels*bpp);
         }
+
+        u32 Texture2D::calcNumBytes() const
+        {
+            return CalcNumBytes(m_format,m_width,m_height);
+        }
+
+        void Texture2D::coalesceUpdates()
+        {
+            auto is_reupload = [](Update const &update) {
+                return ((update.options & Update::ReUpload) == Update::ReUpload);
+            };
+
+            // Drop sub-image updates that are entirely overwritten
+            // by a later update to the same level
+            std::vector<Update> list_kept;
+            list_kept.reserve(m_list_updates.size());
+
+            for(uint i=0; i < m_list_updates.size(); i++) {
+                Update &update = m_list_updates[i];
+                bool overwritten = false;
+
+                if(!is_reupload(update)) {
+                    Rect const rect = getUpdateRect(update);
+
+                    for(uint j=i+1; j < m_list_updates.size(); j++) {
+                        Update const &later = m_list_updates[j];
+                        if(later.mip_level != update.mip_level) {
+                            continue;
+                        }
+
+                        if(is_reupload(later) ||
+                           (later.src_data->data_ptr &&
+                            getContains(getUpdateRect(later),rect))) {
+                            overwritten = true;
+                            break;
+                        }
+                    }
+                }
+
+                if(overwritten) {
+                    KS_GL_STATS_FILTERED(TextureUpload);
+                }
+                else {
+                    list_kept.push_back(std::move(update));
+                }
+            }
+
+            // Group consecutive sub-image updates to the same level
+            // whose union fills their bounding rect. Rects with gaps
+            // aren't merged; the texels in a gap aren't known on the
+            // CPU, so uploading the bounding rect would clobber them
+            struct Group
+            {
+                std::vector<uint> list_updates;
+                Rect rect;
+                bool mergeable;
+            };
+
+            std::vector<Group> list_groups;
+            list_groups.reserve(list_kept.size());
+
+            for(uint i=0; i < list_kept.size(); i++) {
+                Update const &update = list_kept[i];
+                list_groups.push_back(Group{
+                    std::vector<uint>{i},
+                    getUpdateRect(update),
+                    (!is_reupload(update) && update.src_data->data_ptr)
+                });
+            }
+
+            // Repeat so rows of tiles that were merged can
+            // then be merged into blocks
+            bool merged_any = true;
+            while(merged_any) {
+                merged_any = false;
+
+                for(uint i=1; i < list_groups.size();) {
+                    Group &prev = list_groups[i-1];
+                    Group &curr = list_groups[i];
+
+                    Rect merged;
+                    if(prev.mergeable && curr.mergeable &&
+                       list_kept[prev.list_updates[0]].mip_level ==
+                       list_kept[curr.list_updates[0]].mip_level &&
+                       getMergeable(prev.rect,curr.rect,merged)) {
+                        prev.list_updates.insert(prev.list_updates.end(),
+                                                 curr.list_updates.begin(),
+                                                 curr.list_updates.end());
+                        prev.rect = merged;
+                        list_groups.erase(list_groups.begin()+i);
+                        merged_any = true;
+                    }
+                    else {
+                        i++;
+                    }
+                }
+            }
+
+            // Compose each merged group into a staging image in queue
+            // order so later updates still win where they overlap
+            u32 const bytes_per_texel = CalcNumBytes(m_format,1,1);
+
+            m_list_updates.clear();
+            for(Group const &group : list_groups) {
+                if(group.list_updates.size() == 1) {
+                    m_list_updates.push_back(
+                                std::move(list_kept[group.list_updates[0]]));
+                    continue;
+                }
+
+                u32 const width = group.rect.x1-group.rect.x0;
+                u32 const height = group.rect.y1-group.rect.y0;
+                u32 const stride = width*bytes_per_texel;
+
+                std::vector<u8> list_bytes(stride*height);
+
+                for(uint index : group.list_updates) {
+                    Update const &update = list_kept[index];
+                    Rect const rect = getUpdateRect(update);
+
+                    u32 const row_bytes = (rect.x1-rect.x0)*bytes_per_texel;
+                    u32 const src_stride = (update.src_row_bytes == 0) ?
+                                row_bytes : update.src_row_bytes;
+
+                    u8 const * src = static_cast<u8 const *>(update.src_data->data_ptr);
+                    u8 * dst = &(list_bytes[((rect.y0-group.rect.y0)*stride)+
+                                            ((rect.x0-group.rect.x0)*bytes_per_texel)]);
+
+                    for(u32 y=rect.y0; y < rect.y1; y++) {
+                        std::memcpy(dst,src,row_bytes);
+                        src += src_stride;
+                        dst += stride;
+                    }
+                }
+
+                // one upload is issued for the group
+                for(uint i=1; i < group.list_updates.size(); i++) {
+                    KS_GL_STATS_FILTERED(TextureUpload);
+                }
+
+                Update update{
+                    Update::Defaults,
+                    glm::u16vec2(group.rect.x0,group.rect.y0),
+                    make_shared<BufferImageData>(width,height,std::move(list_bytes))
+                };
+                update.mip_level = list_kept[group.list_updates[0]].mip_level;
+
+                m_list_updates.push_back(std::move(update));
+            }
+        }
+
+        void const * Texture2D::glSetUnpackState(StateSet* state_set,
+                                                 Update const &update)
+        {
+            u32 const bytes_per_texel = CalcNumBytes(m_format,1,1);
+            u32 const width = update.src_data->width;
+            u32 const height = update.src_data->height;
+            u32 const row_bytes_packed = width*bytes_per_texel;
+            u32 const row_bytes = (update.src_row_bytes == 0) ?
+                        row_bytes_packed : update.src_row_bytes;
+
+            if(row_bytes < row_bytes_packed) {
+                LOG.Error() << m_log_prefix
+                            << "src_row_bytes is less than the row size";
+                return nullptr;
+            }
+
+            u8 const * src = static_cast<u8 const *>(update.src_data->data_ptr);
+            bool const row_length_supported =
+                    Implementation::GetUnpackRowLengthSupported();
+
+            // Padding GL can skip with the unpack alignment
+            GLint const alignment =
+                    getUnpackAlignment(row_bytes_packed,row_bytes,
+                                       state_set->GetPixelUnpackAlignment());
+            if(alignment > 0) {
+                if(row_length_supported) {
+                    state_set->SetPixelUnpackRowLength(0);
+                }
+                state_set->SetPixelUnpackAlignment(alignment);
+                return src;
+            }
+
+            // Any whole number of texels with the row length
+            if(row_length_supported && (row_bytes % bytes_per_texel == 0)) {
+                state_set->SetPixelUnpackRowLength(row_bytes/bytes_per_texel);
+                state_set->SetPixelUnpackAlignment(
+                            getUnpackAlignment(row_bytes,row_bytes,
+                                               state_set->GetPixelUnpackAlignment()));
+                return src;
+            }
+
+            // Otherwise repack the rows; the scratch buffer is
+            // kept so later updates don't have to allocate
+            m_list_scratch.resize(row_bytes_packed*height);
+            for(u32 y=0; y < height; y++) {
+                std::memcpy(&(m_list_scratch[y*row_bytes_packed]),
+                            src+(y*row_bytes),
+                            row_bytes_packed);
+            }
+
+            if(row_length_supported) {
+                state_set->SetPixelUnpackRowLength(0);
+            }
+            state_set->SetPixelUnpackAlignment(
+                        getUnpackAlignment(row_bytes_packed,row_bytes_packed,
+                                           state_set->GetPixelUnpackAlignment()));
+
+            return m_list_scratch.data();
+        }
+
+        void Texture2D::glUploadCompressed(Update const &update)
+        {
+            if(!update.src_data->data_ptr) {
+                LOG.Error() << m_log_prefix
+                            << "compressed updates must have data";
+                return;
+            }
+
+            u32 const width = update.src_data->width;
+            u32 const height = update.src_data->height;
+            GLsizei const size_bytes = CalcNumBytes(m_format,width,height);
+
+            if((update.options & Update::ReUpload) == Update::ReUpload)
+            {
+                glCompressedTexImage2D(GL_TEXTURE_2D,
+                                       update.mip_level,
+                                       m_gl_format,
+                                       width,
+                                       height,
+                                       0, // border, not used for GLES
+                                       size_bytes,
+                                       update.src_data->data_ptr);
+
+                KS_CHECK_GL_ERROR(m_log_prefix+"upload compressed texture");
+            }
+            else
+            {
+                if(!findCompressedFormat(m_format)->sub_image) {
+                    LOG.Error() << m_log_prefix
+                                << "format doesn't support sub-image updates";
+                    return;
+                }
+
+                // offsets and sizes must be block aligned
+                glCompressedTexSubImage2D(GL_TEXTURE_2D,
+                                          update.mip_level,
+                                          update.src_offset.x,
+                                          update.src_offset.y,
+                                          width,
+                                          height,
+                                          m_gl_format,
+                                          size_bytes,
+                                          update.src_data->data_ptr);
+
+                KS_CHECK_GL_ERROR(m_log_prefix+"upload compressed subimage");
+            }
+
+            KS_GL_STATS_ISSUED(TextureUpload);
+        }
     } // gl
 } // ks
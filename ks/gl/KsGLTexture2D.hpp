@@ -44,17 +44,50 @@ namespace ks
                 RGB565,
                 DEPTH_COMPONENT16,
                 DEPTH_COMPONENT32,
-                DEPTH24_STENCIL8
+                DEPTH24_STENCIL8,
+
+                // compressed; each needs a GL extension,
+                // see GetFormatSupported
+                ETC1_RGB8,
+                DXT1_RGB,
+                DXT1_RGBA,
+                DXT5_RGBA,
+                PVRTC_RGB_4BPP,
+                PVRTC_RGBA_4BPP,
+                PVRTC_RGB_2BPP,
+                PVRTC_RGBA_2BPP,
+                ASTC_4x4_RGBA,
+                ASTC_8x8_RGBA
             };
 
             struct Update
             {
-                static u8 const Defaults    = 0;
-                static u8 const ReUpload    = 1 << 0;
+                static u8 const Defaults        = 0;
+                static u8 const ReUpload        = 1 << 0;
+
+                // * Regenerates mipmap levels 1 and up from level 0
+                //   with glGenerateMipmap after the updates are
+                //   uploaded in GLSync
+                // * NPOT textures can't be mipmapped on GL ES 2
+                //   without GL_OES_texture_npot
+                static u8 const GenerateMipmaps = 1 << 1;
 
                 u8 options;
                 glm::u16vec2 src_offset;
                 shared_ptr<ImageData const> src_data;
+
+                // * Bytes from the start of one row of src_data to the
+                //   next; 0 means rows are tightly packed
+                // * Used to upload padded rows or a rectangle of a
+                //   larger image (see SubImageData) without copying
+                //   them out first. Ignored for compressed formats
+                u32 src_row_bytes{0};
+
+                // * The mipmap level the update applies to; ReUpload
+                //   updates for levels above 0 set precomputed levels
+                //   (see ImageUtils::GenMipmaps) and don't resize
+                //   the texture
+                u8 mip_level{0};
             };
 
             // Note: Textures should only be created after
@@ -64,11 +97,30 @@ namespace ks
 
             ~Texture2D();
 
+            GLenum GetTarget() const;
+
+            Format GetFormat() const;
+
+            // * Estimated size of the texture in GL memory; includes
+            //   mipmap levels if a mipmap min filter is set
+            u32 GetNumBytes() const;
+
             bool GLBind(StateSet* state_set,GLuint tex_unit);
 
             void GLUnbind();
 
-            void GLSync();
+            // * Parameters are set again if the texture is
+            //   initialized after being cleaned up
+            void GLCleanUp();
+
+            // * Sets GL_UNPACK_ALIGNMENT (and GL_UNPACK_ROW_LENGTH where
+            //   available) through @state_set to match each update's
+            //   row pitch; rows that can't be described that way are
+            //   repacked through a scratch buffer
+            // * Makes the unit the texture is bound to active first
+            //   (or binds it to one), so it works after GLBind or
+            //   GLAllocUnitAndBind
+            void GLSync(StateSet* state_set);
 
             uint GetUpdateCount() const;
 
@@ -80,17 +132,52 @@ namespace ks
 
             void SetWrapModes(Wrap wrap_s,Wrap wrap_t);
 
+            // * Compressed formats are uploaded with glCompressedTexImage2D;
+            //   update data must be the block data for the full level
+            //   (or sub-image) as sized by CalcNumBytes
+            // * ETC1 and PVRTC don't support sub-image updates
+            static bool GetFormatCompressed(Format format);
+
+            // * Returns true if the GL implementation supports @format;
+            //   uncompressed formats are always considered supported
+            // * Must only be called after Implementation::GLCapture
+            static bool GetFormatSupported(Format format);
+
+            // * Finds the Format for a GL format and datatype pair, or
+            //   for a compressed internal format if @gl_datatype is 0
+            static bool GetFormatFromGL(GLenum gl_format,
+                                        GLenum gl_datatype,
+                                        Format &format);
+
+            // * Size in bytes of a @width x @height image in @format;
+            //   compressed sizes are rounded up to whole blocks
+            static u32 CalcNumBytes(Format format,u32 width,u32 height);
+
         private:
             // calculate the number of bytes in the texture
             // based on the dimensions, format and datatype
             u32 calcNumBytes() const;
 
+            // * Drops sub-image updates that are overwritten by later
+            //   ones and merges runs of adjacent sub-image updates into
+            //   a single staging image, so GLSync issues fewer uploads
+            // * Only for uncompressed formats
+            void coalesceUpdates();
+
+            void glUploadCompressed(Update const &update);
+
+            // * Sets the unpack state for @update and returns the
+            //   data to upload, or nullptr if the row pitch is invalid
+            void const * glSetUnpackState(StateSet* state_set,
+                                          Update const &update);
+
             u16 m_width;
             u16 m_height;
             Format m_format;
 
             GLenum m_gl_format;
             GLenum m_gl_datatype;
+            bool m_compressed;
 
             Filter m_filter_min;
             Filter m_filter_mag;
@@ -99,8 +186,10 @@ namespace ks
             Wrap m_wrap_t;
 
             bool m_upd_params;
+            bool m_upd_mipmaps;
 
             std::vector<Update> m_list_updates;
+            std::vector<u8> m_list_scratch;
         };
     } // gl
 } // ks
@@ -0,0 +1,482 @@
+/*
+   Copyright (C) 2015 Preet Desai (preet.desai@gmail.com)
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+// stl
+#include <algorithm>
+#include <cstring>
+#include <limits>
+
+// ks
+#include <ks/gl/KsGLImageUtils.hpp>
+#include <ks/gl/KsGLTextureAtlas.hpp>
+
+namespace ks
+{
+    namespace gl
+    {
+        TextureAtlas::TextureAtlas(Texture2D::Format format,
+                                   u16 page_width,
+                                   u16 page_height,
+                                   uint max_pages,
+                                   u16 padding) :
+            m_format(format),
+            m_page_width(page_width),
+            m_page_height(page_height),
+            m_max_pages(max_pages),
+            m_padding(padding),
+            m_bytes_per_texel(Texture2D::CalcNumBytes(format,1,1)),
+            m_log_prefix("TextureAtlas: "),
+            m_id_counter(0),
+            m_frame(0)
+        {
+            if(Texture2D::GetFormatCompressed(m_format) || m_bytes_per_texel == 0) {
+                LOG.Error() << m_log_prefix << "unsupported format";
+            }
+        }
+
+        TextureAtlas::~TextureAtlas()
+        {
+            // empty
+        }
+
+        TextureAtlas::ImageId TextureAtlas::Add(shared_ptr<ImageData const> const &image)
+        {
+            if(image->width == 0 || image->height == 0 ||
+               image->width > m_page_width || image->height > m_page_height ||
+               !image->data_ptr) {
+                LOG.Error() << m_log_prefix << "invalid image";
+                return 0;
+            }
+
+            u16 const width = image->width;
+            u16 const height = image->height;
+            u16 const alloc_width = std::min<uint>(width+m_padding,m_page_width);
+            u16 const alloc_height = std::min<uint>(height+m_padding,m_page_height);
+
+            // Try the existing pages, then a new page, then
+            // evicting from existing pages
+            uint page_index = 0;
+            u16 x,y;
+            bool placed = false;
+
+            for(; page_index < m_list_pages.size(); page_index++) {
+                if(insert(m_list_pages[page_index],alloc_width,alloc_height,x,y)) {
+                    placed = true;
+                    break;
+                }
+            }
+
+            if(!placed && m_list_pages.size() < m_max_pages) {
+                addPage();
+                page_index = m_list_pages.size()-1;
+                placed = insert(m_list_pages[page_index],alloc_width,alloc_height,x,y);
+            }
+
+            if(!placed) {
+                // Evict from the pages with the least
+                // recently used images first
+                std::vector<std::pair<u64,uint>> list_pages_by_lru;
+                for(uint i=0; i < m_list_pages.size(); i++) {
+                    u64 oldest = m_frame;
+                    for(ImageId id : m_list_pages[i].list_images) {
+                        oldest = std::min(oldest,m_lkup_entries[id].last_used);
+                    }
+                    list_pages_by_lru.emplace_back(oldest,i);
+                }
+                std::sort(list_pages_by_lru.begin(),list_pages_by_lru.end());
+
+                for(auto const &lru_page : list_pages_by_lru) {
+                    page_index = lru_page.second;
+                    if(evictAndInsert(page_index,alloc_width,alloc_height,x,y)) {
+                        placed = true;
+                        break;
+                    }
+                }
+            }
+
+            if(!placed) {
+                LOG.Warn() << m_log_prefix << "no space for "
+                           << width << "x" << height << " image";
+                return 0;
+            }
+
+            Page &page = m_list_pages[page_index];
+
+            ImageId const id = ++m_id_counter;
+            m_lkup_entries[id] = Entry{page_index,x,y,width,height,m_frame};
+            page.list_images.push_back(id);
+            page.used_area += alloc_width*alloc_height;
+
+            uint const src_stride = width*m_bytes_per_texel;
+            writeTexels(page,x,y,width,height,
+                        static_cast<u8 const*>(image->data_ptr),
+                        src_stride);
+
+            return id;
+        }
+
+        void TextureAtlas::Remove(ImageId id)
+        {
+            auto it = m_lkup_entries.find(id);
+            if(it == m_lkup_entries.end()) {
+                return;
+            }
+
+            // The space is reclaimed the next time the page is repacked
+            removeFromPage(it->second,id);
+            m_lkup_entries.erase(it);
+        }
+
+        bool TextureAtlas::Get(ImageId id,Region &region)
+        {
+            auto it = m_lkup_entries.find(id);
+            if(it == m_lkup_entries.end()) {
+                return false;
+            }
+
+            Entry &entry = it->second;
+            entry.last_used = m_frame;
+
+            region.page = entry.page;
+            region.offset = glm::u16vec2(entry.x,entry.y);
+            region.size = glm::u16vec2(entry.width,entry.height);
+
+            region.uv_min = glm::vec2(
+                        float(entry.x)/m_page_width,
+                        float(entry.y)/m_page_height);
+
+            region.uv_max = glm::vec2(
+                        float(entry.x+entry.width)/m_page_width,
+                        float(entry.y+entry.height)/m_page_height);
+
+            return true;
+        }
+
+        uint TextureAtlas::GetPageCount() const
+        {
+            return m_list_pages.size();
+        }
+
+        Texture2D* TextureAtlas::GetPage(uint page) const
+        {
+            return m_list_pages[page].texture.get();
+        }
+
+        void TextureAtlas::GLSync(StateSet* state_set)
+        {
+            uint const row_bytes = m_page_width*m_bytes_per_texel;
+
+            for(auto &page : m_list_pages) {
+                if(!page.upload_all && (page.dirty_y1 <= page.dirty_y0)) {
+                    continue;
+                }
+
+                Texture2D* texture = page.texture.get();
+                if(texture->GetHandle() == 0) {
+                    texture->GLInit();
+                    page.upload_all = true;
+                }
+
+                if(page.upload_all) {
+                    texture->UpdateTexture(
+                                Texture2D::Update{
+                                    Texture2D::Update::ReUpload,
+                                    glm::u16vec2(0,0),
+                                    make_shared<BufferImageData>(
+                                        m_page_width,
+                                        m_page_height,
+                                        page.list_texels)
+                                });
+                }
+                else {
+                    // Page rows are contiguous, so every change
+                    // this frame is covered by one sub-image
+                    auto const band_begin = page.list_texels.begin()+page.dirty_y0*row_bytes;
+                    auto const band_end = page.list_texels.begin()+page.dirty_y1*row_bytes;
+
+                    texture->UpdateTexture(
+                                Texture2D::Update{
+                                    Texture2D::Update::Defaults,
+                                    glm::u16vec2(0,page.dirty_y0),
+                                    make_shared<BufferImageData>(
+                                        m_page_width,
+                                        page.dirty_y1-page.dirty_y0,
+                                        std::vector<u8>(band_begin,band_end))
+                                });
+                }
+
+                texture->GLBind(state_set,0);
+                texture->GLSync(state_set);
+
+                page.upload_all = false;
+                page.dirty_y0 = m_page_height;
+                page.dirty_y1 = 0;
+            }
+
+            m_frame++;
+        }
+
+        void TextureAtlas::GLCleanUp()
+        {
+            for(auto &page : m_list_pages) {
+                page.texture->GLCleanUp();
+            }
+
+            m_list_pages.clear();
+            m_lkup_entries.clear();
+        }
+
+        bool TextureAtlas::insert(Page &page,u16 width,u16 height,u16 &x,u16 &y)
+        {
+            // Skyline bottom-left: pick the position that leaves
+            // the lowest top edge, breaking ties by node width
+            auto &list_nodes = page.list_skyline;
+
+            sint best_index = -1;
+            sint best_top = std::numeric_limits<sint>::max();
+            sint best_width = std::numeric_limits<sint>::max();
+            sint best_y = 0;
+
+            for(uint i=0; i < list_nodes.size(); i++) {
+                if(list_nodes[i].x + width > m_page_width) {
+                    break; // nodes are sorted by x
+                }
+
+                // the highest node under the span sets y
+                sint fit_y = 0;
+                sint width_left = width;
+                for(uint j=i; width_left > 0; j++) {
+                    fit_y = std::max<sint>(fit_y,list_nodes[j].y);
+                    width_left -= list_nodes[j].width;
+                }
+
+                if(fit_y + height > m_page_height) {
+                    continue;
+                }
+
+                sint const top = fit_y+height;
+                if(top < best_top ||
+                   (top == best_top && list_nodes[i].width < best_width)) {
+                    best_index = i;
+                    best_top = top;
+                    best_width = list_nodes[i].width;
+                    best_y = fit_y;
+                }
+            }
+
+            if(best_index < 0) {
+                return false;
+            }
+
+            x = list_nodes[best_index].x;
+            y = best_y;
+
+            // Add the new node and shrink or remove the
+            // nodes it now covers
+            list_nodes.insert(list_nodes.begin()+best_index,
+                              SkylineNode{x,static_cast<u16>(best_top),width});
+
+            for(uint i=best_index+1; i < list_nodes.size(); ) {
+                SkylineNode const &prev = list_nodes[i-1];
+                sint const overlap = (prev.x+prev.width)-list_nodes[i].x;
+                if(overlap <= 0) {
+                    break;
+                }
+
+                if(overlap >= list_nodes[i].width) {
+                    list_nodes.erase(list_nodes.begin()+i);
+                    continue;
+                }
+
+                list_nodes[i].x += overlap;
+                list_nodes[i].width -= overlap;
+                break;
+            }
+
+            // Merge neighbours at the same height
+            for(uint i=1; i < list_nodes.size(); ) {
+                if(list_nodes[i-1].y == list_nodes[i].y) {
+                    list_nodes[i-1].width += list_nodes[i].width;
+                    list_nodes.erase(list_nodes.begin()+i);
+                }
+                else {
+                    i++;
+                }
+            }
+
+            return true;
+        }
+
+        void TextureAtlas::addPage()
+        {
+            Page page;
+            page.texture = make_unique<Texture2D>(m_format);
+            page.texture->SetFilterModes(Texture::Filter::Linear,
+                                         Texture::Filter::Linear);
+
+            page.list_texels.assign(m_page_width*m_page_height*m_bytes_per_texel,0);
+            page.list_skyline.push_back(SkylineNode{0,0,m_page_width});
+            page.used_area = 0;
+            page.upload_all = true;
+            page.dirty_y0 = m_page_height;
+            page.dirty_y1 = 0;
+
+            m_list_pages.push_back(std::move(page));
+        }
+
+        bool TextureAtlas::repack(uint page_index)
+        {
+            Page &page = m_list_pages[page_index];
+
+            // Taller images first packs better
+            std::vector<ImageId> list_images = page.list_images;
+            std::sort(list_images.begin(),
+                      list_images.end(),
+                      [this](ImageId a,ImageId b) {
+                          return m_lkup_entries[a].height > m_lkup_entries[b].height;
+                      });
+
+            // Place every image before moving any texels so the
+            // page can be left as it was if one doesn't fit
+            std::vector<SkylineNode> list_old_skyline;
+            list_old_skyline.swap(page.list_skyline);
+            page.list_skyline.push_back(SkylineNode{0,0,m_page_width});
+
+            std::vector<glm::u16vec2> list_positions;
+            list_positions.reserve(list_images.size());
+
+            for(ImageId id : list_images) {
+                Entry const &entry = m_lkup_entries[id];
+                u16 const alloc_width = std::min<uint>(entry.width+m_padding,m_page_width);
+                u16 const alloc_height = std::min<uint>(entry.height+m_padding,m_page_height);
+
+                u16 x,y;
+                if(!insert(page,alloc_width,alloc_height,x,y)) {
+                    // Packing order changed enough that this
+                    // image no longer fits
+                    page.list_skyline.swap(list_old_skyline);
+                    return false;
+                }
+                list_positions.emplace_back(x,y);
+            }
+
+            std::vector<u8> list_old_texels(page.list_texels.size(),0);
+            list_old_texels.swap(page.list_texels);
+
+            uint const old_stride = m_page_width*m_bytes_per_texel;
+
+            for(uint i=0; i < list_images.size(); i++) {
+                Entry &entry = m_lkup_entries[list_images[i]];
+                u16 const x = list_positions[i].x;
+                u16 const y = list_positions[i].y;
+
+                u8 const * src = &(list_old_texels[
+                        (entry.y*m_page_width + entry.x)*m_bytes_per_texel]);
+
+                writeTexels(page,x,y,entry.width,entry.height,src,old_stride);
+
+                entry.x = x;
+                entry.y = y;
+            }
+
+            page.list_images = std::move(list_images);
+            page.upload_all = true;
+
+            return true;
+        }
+
+        bool TextureAtlas::evictAndInsert(uint page_index,
+                                          u16 width,u16 height,
+                                          u16 &x,u16 &y)
+        {
+            Page &page = m_list_pages[page_index];
+
+            // Images used this frame can't be evicted
+            std::vector<ImageId> list_evictable;
+            for(ImageId id : page.list_images) {
+                if(m_lkup_entries[id].last_used < m_frame) {
+                    list_evictable.push_back(id);
+                }
+            }
+
+            std::sort(list_evictable.begin(),
+                      list_evictable.end(),
+                      [this](ImageId a,ImageId b) {
+                          return m_lkup_entries[a].last_used < m_lkup_entries[b].last_used;
+                      });
+
+            u32 const page_area = m_page_width*m_page_height;
+            u32 const area = width*height;
+
+            uint next = 0;
+            while(true) {
+                // A failed repack leaves the page as it was
+                if((page_area-page.used_area >= area) &&
+                   repack(page_index) &&
+                   insert(page,width,height,x,y)) {
+                    return true;
+                }
+
+                if(next == list_evictable.size()) {
+                    return false;
+                }
+
+                ImageId const id = list_evictable[next++];
+                auto it = m_lkup_entries.find(id);
+                removeFromPage(it->second,id);
+                m_lkup_entries.erase(it);
+            }
+        }
+
+        void TextureAtlas::removeFromPage(Entry const &entry,ImageId id)
+        {
+            Page &page = m_list_pages[entry.page];
+
+            page.list_images.erase(
+                        std::remove(page.list_images.begin(),
+                                    page.list_images.end(),
+                                    id),
+                        page.list_images.end());
+
+            u16 const alloc_width = std::min<uint>(entry.width+m_padding,m_page_width);
+            u16 const alloc_height = std::min<uint>(entry.height+m_padding,m_page_height);
+            page.used_area -= alloc_width*alloc_height;
+        }
+
+        void TextureAtlas::writeTexels(Page &page,
+                                       u16 x,u16 y,
+                                       u16 width,u16 height,
+                                       u8 const * src,
+                                       uint src_stride)
+        {
+            uint const dst_stride = m_page_width*m_bytes_per_texel;
+            uint const row_bytes = width*m_bytes_per_texel;
+
+            u8 * dst = &(page.list_texels[(y*m_page_width + x)*m_bytes_per_texel]);
+            for(uint row=0; row < height; row++) {
+                std::memcpy(dst+row*dst_stride,src+row*src_stride,row_bytes);
+            }
+
+            markDirty(page,y,height);
+        }
+
+        void TextureAtlas::markDirty(Page &page,u16 y,u16 height)
+        {
+            page.dirty_y0 = std::min(page.dirty_y0,y);
+            page.dirty_y1 = std::max<u16>(page.dirty_y1,y+height);
+        }
+    }
+}
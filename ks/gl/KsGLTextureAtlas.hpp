@@ -0,0 +1,161 @@
+/*
+   Copyright (C) 2015 Preet Desai (preet.desai@gmail.com)
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#ifndef KS_GL_TEXTURE_ATLAS_HPP
+#define KS_GL_TEXTURE_ATLAS_HPP
+
+// stl
+#include <unordered_map>
+#include <vector>
+
+// glm
+#include <glm/vec2.hpp>
+
+// ks
+#include <ks/gl/KsGLTexture2D.hpp>
+
+namespace ks
+{
+    namespace gl
+    {
+        // TextureAtlas
+        // * Packs many small images into a few large Texture2D
+        //   pages so they can be drawn without rebinding
+        // * Images are placed with a skyline bottom-left packer.
+        //   When every page is full, the least recently used
+        //   images on a page are evicted and the page is repacked
+        // * Each page keeps a CPU copy of its texels; all of the
+        //   changes to a page in a frame are uploaded with a single
+        //   glTexSubImage2D covering the rows that changed
+        // * Only uncompressed formats are supported. Source rows
+        //   must be tightly packed
+        // * Must only be used from the rendering thread
+        class TextureAtlas final
+        {
+        public:
+            using ImageId = u32;
+
+            struct Region
+            {
+                uint page;
+                glm::u16vec2 offset;
+                glm::u16vec2 size;
+                glm::vec2 uv_min;
+                glm::vec2 uv_max;
+            };
+
+            // * @padding empty texels are left to the right of and
+            //   below each image to prevent filtering from bleeding
+            //   between neighbours
+            TextureAtlas(Texture2D::Format format,
+                         u16 page_width,
+                         u16 page_height,
+                         uint max_pages,
+                         u16 padding=1);
+
+            ~TextureAtlas();
+
+            // * Adds @image and returns its id, or 0 if it can't
+            //   be placed even after evicting images that haven't
+            //   been used this frame
+            ImageId Add(shared_ptr<ImageData const> const &image);
+
+            void Remove(ImageId id);
+
+            // * Returns false if @id isn't in the atlas (ie. it was
+            //   evicted). Marks the image as used this frame
+            // * Regions move when a page is repacked, so they should
+            //   be looked up every frame rather than stored
+            bool Get(ImageId id,Region &region);
+
+            uint GetPageCount() const;
+            Texture2D* GetPage(uint page) const;
+
+            // * Creates textures for new pages and uploads any
+            //   changes, then starts a new frame for LRU tracking
+            void GLSync(StateSet* state_set);
+
+            void GLCleanUp();
+
+        private:
+            struct SkylineNode
+            {
+                u16 x;
+                u16 y;
+                u16 width;
+            };
+
+            struct Page
+            {
+                unique_ptr<Texture2D> texture;
+                std::vector<u8> list_texels;
+                std::vector<SkylineNode> list_skyline;
+                std::vector<ImageId> list_images;
+                u32 used_area;
+
+                bool upload_all;
+                u16 dirty_y0;
+                u16 dirty_y1; // exclusive
+            };
+
+            struct Entry
+            {
+                uint page;
+                u16 x;
+                u16 y;
+                u16 width;
+                u16 height;
+                u64 last_used;
+            };
+
+            bool insert(Page &page,u16 width,u16 height,u16 &x,u16 &y);
+            void addPage();
+            // * Packs the page's images again to reclaim the space
+            //   left by removed ones; returns false and leaves the
+            //   page unchanged if they no longer all fit
+            bool repack(uint page_index);
+            bool evictAndInsert(uint page_index,
+                                u16 width,u16 height,
+                                u16 &x,u16 &y);
+
+            void removeFromPage(Entry const &entry,ImageId id);
+
+            void writeTexels(Page &page,
+                             u16 x,u16 y,
+                             u16 width,u16 height,
+                             u8 const * src,
+                             uint src_stride);
+
+            void markDirty(Page &page,u16 y,u16 height);
+
+            Texture2D::Format const m_format;
+            u16 const m_page_width;
+            u16 const m_page_height;
+            uint const m_max_pages;
+            u16 const m_padding;
+            uint const m_bytes_per_texel;
+
+            std::string const m_log_prefix;
+
+            std::vector<Page> m_list_pages;
+            std::unordered_map<ImageId,Entry> m_lkup_entries;
+            ImageId m_id_counter;
+            u64 m_frame;
+        };
+    }
+}
+
+#endif // KS_GL_TEXTURE_ATLAS_HPP
@@ -0,0 +1,235 @@
+/*
+   Copyright (C) 2015 Preet Desai (preet.desai@gmail.com)
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+// ks
+#include <ks/gl/KsGLImageUtils.hpp>
+#include <ks/gl/KsGLTextureResidency.hpp>
+
+namespace ks
+{
+    namespace gl
+    {
+        TextureResidency::TextureResidency(TextureStreamer* streamer,
+                                           u64 byte_budget) :
+            m_streamer(streamer),
+            m_log_prefix("gl: TextureResidency: "),
+            m_byte_budget(byte_budget),
+            m_resident_bytes(0),
+            m_eviction_count(0),
+            m_reload_count(0),
+            m_frame(0)
+        {
+            // empty
+        }
+
+        TextureResidency::~TextureResidency()
+        {
+            for(auto &it : m_lkup_entries) {
+                if(it.second.state == State::Loading) {
+                    m_streamer->Cancel(it.second.request_id);
+                }
+            }
+        }
+
+        bool TextureResidency::Add(TextureStreamer::Request request,sint priority)
+        {
+            if(!request.texture) {
+                LOG.Error() << m_log_prefix << "request has no texture";
+                return false;
+            }
+
+            if((request.options & Texture2D::Update::ReUpload) !=
+               Texture2D::Update::ReUpload) {
+                LOG.Error() << m_log_prefix << "request must be a ReUpload";
+                return false;
+            }
+
+            Texture2D* texture = request.texture.get();
+            Remove(texture);
+
+            Entry entry;
+            entry.texture = request.texture;
+            entry.request = std::move(request);
+            entry.priority = priority;
+            entry.state = State::Evicted;
+            entry.request_id = 0;
+            entry.num_bytes = 0;
+            entry.bind_count = texture->GetBindCount();
+            entry.last_used = m_frame;
+
+            // The entry must not keep the texture alive
+            entry.request.texture.reset();
+
+            load(entry);
+            m_lkup_entries.emplace(texture,std::move(entry));
+
+            return true;
+        }
+
+        void TextureResidency::Remove(Texture2D* texture)
+        {
+            auto it = m_lkup_entries.find(texture);
+            if(it == m_lkup_entries.end()) {
+                return;
+            }
+
+            if(it->second.state == State::Loading) {
+                m_streamer->Cancel(it->second.request_id);
+            }
+
+            m_lkup_entries.erase(it);
+        }
+
+        void TextureResidency::SetPriority(Texture2D* texture,sint priority)
+        {
+            auto it = m_lkup_entries.find(texture);
+            if(it != m_lkup_entries.end()) {
+                it->second.priority = priority;
+            }
+        }
+
+        void TextureResidency::SetByteBudget(u64 byte_budget)
+        {
+            m_byte_budget = byte_budget;
+        }
+
+        u64 TextureResidency::GetResidentBytes() const
+        {
+            return m_resident_bytes;
+        }
+
+        u64 TextureResidency::GetEvictionCount() const
+        {
+            return m_eviction_count;
+        }
+
+        u64 TextureResidency::GetReloadCount() const
+        {
+            return m_reload_count;
+        }
+
+        void TextureResidency::GLUpdate(StateSet* state_set)
+        {
+            m_resident_bytes = 0;
+
+            for(auto it = m_lkup_entries.begin(); it != m_lkup_entries.end();) {
+                Entry &entry = it->second;
+
+                shared_ptr<Texture2D> texture = entry.texture.lock();
+                if(!texture) {
+                    if(entry.state == State::Loading) {
+                        m_streamer->Cancel(entry.request_id);
+                    }
+                    it = m_lkup_entries.erase(it);
+                    continue;
+                }
+
+                // Bound since the last update
+                u32 const bind_count = texture->GetBindCount();
+                if(bind_count != entry.bind_count) {
+                    entry.bind_count = bind_count;
+                    entry.last_used = m_frame;
+
+                    if(entry.state == State::Evicted) {
+                        load(entry);
+                        m_reload_count++;
+                    }
+                }
+
+                if(entry.state == State::Loading &&
+                   m_streamer->GetDone(entry.request_id)) {
+                    entry.state = State::Resident;
+                }
+
+                if(entry.state == State::Resident) {
+                    entry.num_bytes = texture->GetNumBytes();
+                }
+
+                // Loading textures are counted with the size they
+                // had when they were last resident
+                if(entry.state != State::Evicted) {
+                    m_resident_bytes += entry.num_bytes;
+                }
+
+                ++it;
+            }
+
+            while(m_resident_bytes > m_byte_budget) {
+                // Lowest priority, then least recently used
+                auto evict_it = m_lkup_entries.end();
+                for(auto it = m_lkup_entries.begin(); it != m_lkup_entries.end(); ++it) {
+                    Entry const &entry = it->second;
+                    if(entry.state != State::Resident || entry.last_used == m_frame) {
+                        continue;
+                    }
+
+                    if(evict_it == m_lkup_entries.end() ||
+                       entry.priority < evict_it->second.priority ||
+                       (entry.priority == evict_it->second.priority &&
+                        entry.last_used < evict_it->second.last_used)) {
+                        evict_it = it;
+                    }
+                }
+
+                if(evict_it == m_lkup_entries.end()) {
+                    // Everything left was used this frame
+                    break;
+                }
+
+                m_resident_bytes -= evict_it->second.num_bytes;
+                glEvict(state_set,evict_it->first,evict_it->second);
+                m_eviction_count++;
+            }
+
+            m_frame++;
+        }
+
+        void TextureResidency::load(Entry &entry)
+        {
+            TextureStreamer::Request request = entry.request;
+            request.texture = entry.texture.lock();
+
+            entry.request_id = m_streamer->Add(std::move(request));
+            entry.state = State::Loading;
+        }
+
+        void TextureResidency::glEvict(StateSet* state_set,
+                                       Texture2D* texture,
+                                       Entry &entry)
+        {
+            texture->GLCleanUp();
+
+            // Keep a 1x1 placeholder so the texture can still
+            // be bound until it has been reloaded
+            Texture2D::Format const format = texture->GetFormat();
+            texture->GLInit();
+            texture->UpdateTexture(
+                        Texture2D::Update{
+                            Texture2D::Update::ReUpload,
+                            glm::u16vec2(0,0),
+                            make_shared<BufferImageData>(
+                                1,1,std::vector<u8>(
+                                    Texture2D::CalcNumBytes(format,1,1),0))
+                        });
+
+            // GLSync binds the placeholder without counting it as a use
+            texture->GLSync(state_set);
+
+            entry.bind_count = texture->GetBindCount();
+            entry.state = State::Evicted;
+        }
+    }
+}
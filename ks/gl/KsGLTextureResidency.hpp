@@ -0,0 +1,112 @@
+/*
+   Copyright (C) 2015 Preet Desai (preet.desai@gmail.com)
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#ifndef KS_GL_TEXTURE_RESIDENCY_HPP
+#define KS_GL_TEXTURE_RESIDENCY_HPP
+
+// stl
+#include <unordered_map>
+
+// ks
+#include <ks/gl/KsGLTextureStreamer.hpp>
+
+namespace ks
+{
+    namespace gl
+    {
+        // TextureResidency
+        // * Keeps the Texture2Ds it manages under a memory budget
+        //   by evicting textures that haven't been bound recently
+        //   and reloading them through a TextureStreamer when
+        //   they're bound again
+        // * Lower priority textures are evicted first, then the
+        //   ones that were bound least recently. Textures bound
+        //   in the current frame are never evicted
+        // * An evicted texture is cleaned up and replaced by a 1x1
+        //   placeholder, so it can still be bound (and its use
+        //   detected) while it's being reloaded
+        // * Must only be used from the rendering thread
+        class TextureResidency final
+        {
+        public:
+            // * @streamer must outlive this
+            TextureResidency(TextureStreamer* streamer,u64 byte_budget);
+            ~TextureResidency();
+
+            // * @request is used to load the texture now and to
+            //   reload it after it's evicted, so it must be a
+            //   ReUpload of the whole texture
+            // * Textures are held weakly and dropped once destroyed
+            bool Add(TextureStreamer::Request request,sint priority=0);
+
+            void Remove(Texture2D* texture);
+
+            void SetPriority(Texture2D* texture,sint priority);
+
+            void SetByteBudget(u64 byte_budget);
+
+            // * Estimated from Texture2D::GetNumBytes, including
+            //   textures that are being loaded
+            u64 GetResidentBytes() const;
+
+            u64 GetEvictionCount() const;
+            u64 GetReloadCount() const;
+
+            // * Should be called once a frame after drawing. Reloads
+            //   evicted textures that were bound this frame and then
+            //   evicts textures until the budget is met
+            void GLUpdate(StateSet* state_set);
+
+        private:
+            enum class State : u8
+            {
+                Loading,
+                Resident,
+                Evicted
+            };
+
+            struct Entry
+            {
+                std::weak_ptr<Texture2D> texture;
+                TextureStreamer::Request request;
+                sint priority;
+
+                State state;
+                TextureStreamer::RequestId request_id;
+                u32 num_bytes;
+
+                u32 bind_count;
+                u64 last_used;
+            };
+
+            void load(Entry &entry);
+            void glEvict(StateSet* state_set,Texture2D* texture,Entry &entry);
+
+            TextureStreamer* const m_streamer;
+            std::string const m_log_prefix;
+
+            u64 m_byte_budget;
+            u64 m_resident_bytes;
+            u64 m_eviction_count;
+            u64 m_reload_count;
+            u64 m_frame;
+
+            std::unordered_map<Texture2D*,Entry> m_lkup_entries;
+        };
+    }
+}
+
+#endif // KS_GL_TEXTURE_RESIDENCY_HPP
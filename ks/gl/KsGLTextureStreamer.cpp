@@ -0,0 +1,367 @@
+/*
+   Copyright (C) 2015 Preet Desai (preet.desai@gmail.com)
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+// stl
+#include <algorithm>
+
+// ks
+#include <ks/gl/KsGLImageUtils.hpp>
+#include <ks/gl/KsGLTextureStreamer.hpp>
+
+namespace ks
+{
+    namespace gl
+    {
+        namespace
+        {
+            template<typename JobPtr>
+            void eraseJob(std::vector<JobPtr> &list_jobs,
+                          TextureStreamer::RequestId id)
+            {
+                list_jobs.erase(
+                            std::remove_if(
+                                list_jobs.begin(),
+                                list_jobs.end(),
+                                [id](JobPtr const &job) {
+                                    return (job->id == id);
+                                }),
+                            list_jobs.end());
+            }
+        }
+
+        // ============================================================= //
+
+        TextureStreamer::TextureStreamer(uint thread_count) :
+            m_log_prefix("gl: TextureStreamer: "),
+            m_stop(false),
+            m_id_counter(0)
+        {
+            thread_count = std::max<uint>(thread_count,1);
+            for(uint i=0; i < thread_count; i++) {
+                m_list_threads.emplace_back(&TextureStreamer::work,this);
+            }
+        }
+
+        TextureStreamer::~TextureStreamer()
+        {
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_stop = true;
+            }
+            m_cv.notify_all();
+
+            for(auto &thread : m_list_threads) {
+                thread.join();
+            }
+        }
+
+        TextureStreamer::RequestId TextureStreamer::Add(Request request)
+        {
+            auto job = make_shared<Job>();
+            job->texture = request.texture;
+            job->load = std::move(request.load);
+            job->options = request.options;
+            job->offset = request.offset;
+            job->mip_level = request.mip_level;
+            job->src_row_bytes = request.src_row_bytes;
+            job->priority = request.priority;
+            job->cancelled = false;
+            job->next_row = 0;
+
+            RequestId id;
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                id = ++m_id_counter;
+                job->id = id;
+                m_lkup_jobs.emplace(id,job);
+                m_list_pending.push_back(std::move(job));
+            }
+            m_cv.notify_one();
+
+            return id;
+        }
+
+        void TextureStreamer::SetPriority(RequestId id,sint priority)
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            auto it = m_lkup_jobs.find(id);
+            if(it != m_lkup_jobs.end()) {
+                it->second->priority = priority;
+            }
+        }
+
+        void TextureStreamer::Cancel(RequestId id)
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            auto it = m_lkup_jobs.find(id);
+            if(it == m_lkup_jobs.end()) {
+                return;
+            }
+
+            // A worker may be loading it; the result is
+            // dropped once the load returns
+            it->second->cancelled = true;
+            m_lkup_jobs.erase(it);
+
+            eraseJob(m_list_pending,id);
+            eraseJob(m_list_loaded,id);
+        }
+
+        bool TextureStreamer::GetDone(RequestId id)
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            return (m_lkup_jobs.find(id) == m_lkup_jobs.end());
+        }
+
+        uint TextureStreamer::GetPendingCount()
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            return m_lkup_jobs.size();
+        }
+
+        u32 TextureStreamer::GLUpdate(StateSet* state_set,
+                                      u32 byte_budget,
+                                      std::chrono::microseconds time_budget)
+        {
+            auto const start = std::chrono::steady_clock::now();
+
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+
+                m_list_uploading.insert(m_list_uploading.end(),
+                                        m_list_loaded.begin(),
+                                        m_list_loaded.end());
+                m_list_loaded.clear();
+
+                m_list_uploading.erase(
+                            std::remove_if(
+                                m_list_uploading.begin(),
+                                m_list_uploading.end(),
+                                [](shared_ptr<Job> const &job) {
+                                    return job->cancelled;
+                                }),
+                            m_list_uploading.end());
+
+                // Priorities may have changed since the last frame;
+                // stable so equal priorities stay first come first
+                // served and partially uploaded images keep going
+                std::stable_sort(m_list_uploading.begin(),
+                                 m_list_uploading.end(),
+                                 [](shared_ptr<Job> const &a,
+                                    shared_ptr<Job> const &b) {
+                                     return (a->priority > b->priority);
+                                 });
+            }
+
+            u32 bytes = 0;
+            for(uint i=0; i < m_list_uploading.size();) {
+                bool const force = (bytes == 0);
+                if(!force && ((bytes >= byte_budget) ||
+                              (std::chrono::steady_clock::now()-start >= time_budget))) {
+                    break;
+                }
+
+                bool done = false;
+                u32 const uploaded =
+                        glUpload(state_set,
+                                 *(m_list_uploading[i]),
+                                 byte_budget-std::min(bytes,byte_budget),
+                                 force,
+                                 done);
+                bytes += uploaded;
+
+                if(done) {
+                    {
+                        std::lock_guard<std::mutex> lock(m_mutex);
+                        m_lkup_jobs.erase(m_list_uploading[i]->id);
+                    }
+                    m_list_uploading.erase(m_list_uploading.begin()+i);
+                }
+                else if(uploaded == 0) {
+                    // Doesn't fit in what's left of the budget
+                    break;
+                }
+                else {
+                    i++;
+                }
+            }
+
+            return bytes;
+        }
+
+        void TextureStreamer::work()
+        {
+            while(true) {
+                shared_ptr<Job> job;
+                {
+                    std::unique_lock<std::mutex> lock(m_mutex);
+                    m_cv.wait(lock,[this]() {
+                        return (m_stop || !m_list_pending.empty());
+                    });
+
+                    if(m_stop) {
+                        return;
+                    }
+
+                    // max_element returns the first of equal
+                    // priorities, so they load in request order
+                    auto it = std::max_element(
+                                m_list_pending.begin(),
+                                m_list_pending.end(),
+                                [](shared_ptr<Job> const &a,
+                                   shared_ptr<Job> const &b) {
+                                    return (a->priority < b->priority);
+                                });
+
+                    job = std::move(*it);
+                    m_list_pending.erase(it);
+                }
+
+                shared_ptr<ImageData const> image = job->load();
+
+                std::lock_guard<std::mutex> lock(m_mutex);
+                if(job->cancelled) {
+                    continue;
+                }
+
+                if(!image || !image->data_ptr) {
+                    LOG.Error() << m_log_prefix << "failed to load request "
+                                << job->id;
+                    m_lkup_jobs.erase(job->id);
+                    continue;
+                }
+
+                job->image = std::move(image);
+                m_list_loaded.push_back(std::move(job));
+            }
+        }
+
+        u32 TextureStreamer::glUpload(StateSet* state_set,
+                                      Job &job,
+                                      u32 byte_budget,
+                                      bool force,
+                                      bool &done)
+        {
+            shared_ptr<Texture2D> texture = job.texture.lock();
+            if(!texture) {
+                done = true;
+                return 0;
+            }
+
+            Texture2D::Format const format = texture->GetFormat();
+            u32 const width = job.image->width;
+            u32 const height = job.image->height;
+            u32 const image_bytes = Texture2D::CalcNumBytes(format,width,height);
+
+            if(texture->GetHandle() == 0) {
+                texture->GLInit();
+            }
+
+            // GLSync binds the texture itself; binding it here
+            // would count as a use (see TextureResidency)
+            if(texture->GetHandle() == 0) {
+                LOG.Error() << m_log_prefix << "failed to init texture for request "
+                            << job.id;
+                done = true;
+                return 0;
+            }
+
+            // Compressed images aren't split since strips
+            // would have to be aligned to blocks
+            bool const whole =
+                    (job.next_row == 0) &&
+                    ((image_bytes <= byte_budget) ||
+                     Texture2D::GetFormatCompressed(format) ||
+                     (height == 1));
+
+            if(whole) {
+                if((image_bytes > byte_budget) && !force) {
+                    return 0;
+                }
+
+                Texture2D::Update update{
+                    job.options,
+                    job.offset,
+                    job.image
+                };
+                update.mip_level = job.mip_level;
+                update.src_row_bytes = job.src_row_bytes;
+
+                texture->UpdateTexture(std::move(update));
+                texture->GLSync(state_set);
+
+                done = true;
+                return image_bytes;
+            }
+
+            // Upload as many rows as the budget allows
+            u32 const bytes_per_texel = Texture2D::CalcNumBytes(format,1,1);
+            u32 const row_bytes = width*bytes_per_texel;
+            u32 const src_row_bytes = (job.src_row_bytes == 0) ?
+                        row_bytes : job.src_row_bytes;
+
+            u32 rows = std::min(byte_budget/row_bytes,height-job.next_row);
+            if(rows == 0) {
+                if(!force) {
+                    return 0;
+                }
+                rows = 1;
+            }
+
+            bool const reupload =
+                    ((job.options & Texture2D::Update::ReUpload) ==
+                     Texture2D::Update::ReUpload);
+
+            if(reupload && (job.next_row == 0)) {
+                Texture2D::Update update{
+                    Texture2D::Update::ReUpload,
+                    glm::u16vec2(0,0),
+                    make_shared<EmptyImageData>(width,height)
+                };
+                update.mip_level = job.mip_level;
+
+                texture->UpdateTexture(std::move(update));
+            }
+
+            bool const last = (job.next_row+rows == height);
+            u8 const options = last ?
+                        (job.options & Texture2D::Update::GenerateMipmaps) :
+                        Texture2D::Update::Defaults;
+
+            Texture2D::Update update{
+                options,
+                glm::u16vec2(job.offset.x,job.offset.y+job.next_row),
+                make_shared<SubImageData>(job.image,
+                                          src_row_bytes,
+                                          bytes_per_texel,
+                                          0,
+                                          job.next_row,
+                                          width,
+                                          rows)
+            };
+            update.mip_level = job.mip_level;
+            update.src_row_bytes = src_row_bytes;
+
+            texture->UpdateTexture(std::move(update));
+            texture->GLSync(state_set);
+
+            job.next_row += rows;
+            done = last;
+
+            return rows*row_bytes;
+        }
+    }
+}
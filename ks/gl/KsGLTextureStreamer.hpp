@@ -0,0 +1,151 @@
+/*
+   Copyright (C) 2015 Preet Desai (preet.desai@gmail.com)
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#ifndef KS_GL_TEXTURE_STREAMER_HPP
+#define KS_GL_TEXTURE_STREAMER_HPP
+
+// stl
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+// ks
+#include <ks/gl/KsGLTexture2D.hpp>
+
+namespace ks
+{
+    namespace gl
+    {
+        // TextureStreamer
+        // * Loads images on worker threads and uploads them to
+        //   Texture2Ds on the rendering thread under a per-frame
+        //   byte and time budget, so big uploads don't cause hitches
+        // * Loaded images are uploaded highest priority first.
+        //   Uncompressed images that don't fit in what's left of
+        //   the budget are uploaded in strips of rows over several
+        //   frames
+        // * At least one strip is uploaded per frame so every
+        //   request eventually completes
+        class TextureStreamer final
+        {
+        public:
+            using RequestId = u32;
+
+            struct Request
+            {
+                // * Held weakly; requests for textures that have
+                //   been destroyed are dropped
+                shared_ptr<Texture2D> texture;
+
+                // * Run on a worker thread to decode (and convert,
+                //   ie. with ImageUtils::ConvertTo16Bit) the image;
+                //   returns nullptr on failure
+                std::function<shared_ptr<ImageData const>()> load;
+
+                // * As in Texture2D::Update. GenerateMipmaps is
+                //   applied once the last strip has been uploaded
+                u8 options;
+                glm::u16vec2 offset;
+                u8 mip_level{0};
+
+                // * Row pitch of the loaded image, 0 if tightly packed
+                u32 src_row_bytes{0};
+
+                // * Higher priorities are loaded and uploaded first
+                sint priority{0};
+            };
+
+            TextureStreamer(uint thread_count=1);
+            ~TextureStreamer();
+
+            RequestId Add(Request request);
+
+            void SetPriority(RequestId id,sint priority);
+
+            // * Stops loading and uploading @id; strips that were
+            //   already uploaded aren't undone
+            void Cancel(RequestId id);
+
+            // * Returns true once @id has been completely uploaded
+            //   (or was cancelled, failed or dropped)
+            bool GetDone(RequestId id);
+
+            uint GetPendingCount();
+
+            // * Uploads loaded images until @byte_budget bytes or
+            //   @time_budget have been used; should be called once
+            //   a frame
+            // * Returns the number of bytes uploaded
+            u32 GLUpdate(StateSet* state_set,
+                         u32 byte_budget,
+                         std::chrono::microseconds time_budget);
+
+        private:
+            struct Job
+            {
+                RequestId id;
+                std::weak_ptr<Texture2D> texture;
+                std::function<shared_ptr<ImageData const>()> load;
+                u8 options;
+                glm::u16vec2 offset;
+                u8 mip_level;
+                u32 src_row_bytes;
+                sint priority;
+
+                bool cancelled;
+
+                // set by the worker that loaded the image
+                shared_ptr<ImageData const> image;
+
+                // rows uploaded so far, rendering thread only
+                u32 next_row;
+            };
+
+            void work();
+
+            // * Uploads as much of @job as fits in @byte_budget, or
+            //   at least one strip if @force is set; returns the number
+            //   of bytes uploaded and sets @done once the whole image
+            //   has been uploaded (or can't be)
+            u32 glUpload(StateSet* state_set,
+                         Job &job,
+                         u32 byte_budget,
+                         bool force,
+                         bool &done);
+
+            std::string const m_log_prefix;
+
+            std::mutex m_mutex;
+            std::condition_variable m_cv;
+            bool m_stop;
+            std::vector<std::thread> m_list_threads;
+
+            RequestId m_id_counter;
+            std::unordered_map<RequestId,shared_ptr<Job>> m_lkup_jobs;
+            std::vector<shared_ptr<Job>> m_list_pending; // to load
+            std::vector<shared_ptr<Job>> m_list_loaded; // to upload
+
+            // rendering thread only
+            std::vector<shared_ptr<Job>> m_list_uploading;
+        };
+    }
+}
+
+#endif // KS_GL_TEXTURE_STREAMER_HPP
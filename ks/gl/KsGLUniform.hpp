@@ -16,8 +16,8 @@ namespace ks
         class UniformBase
         {
         public:
-            UniformBase(std::string name) :
-                m_name(std::move(name))
+            UniformBase(UniformHandle handle) :
+                m_handle(std::move(handle))
             {
 
             }
@@ -33,11 +33,16 @@ namespace ks
 
             std::string const &GetName() const
             {
-                return m_name;
+                return m_handle.GetName();
+            }
+
+            UniformHandle const &GetHandle() const
+            {
+                return m_handle;
             }
 
         protected:
-            std::string m_name;
+            UniformHandle m_handle;
         };
 
         // ============================================================= //
@@ -46,8 +51,14 @@ namespace ks
         class Uniform final : public UniformBase
         {
         public:
-            Uniform(std::string name, T data) :
-                UniformBase(name),
+            Uniform(std::string const &name, T data) :
+                Uniform(UniformHandle(name),std::move(data))
+            {
+
+            }
+
+            Uniform(UniformHandle handle, T data) :
+                UniformBase(std::move(handle)),
                 m_data(data),
                 m_update(data)
             {
@@ -58,12 +69,12 @@ namespace ks
 
             void GLSetUniform(gl::ShaderProgram* shader) const
             {
-                shader->GLSetUniform(m_name,m_data);
+                shader->GLSetUniform(m_handle,m_data);
             }
 
             Uniform<T>* Copy() const
             {
-                Uniform<T>* copy = new Uniform<T>(m_name,m_data);
+                Uniform<T>* copy = new Uniform<T>(m_handle,m_data);
                 copy->m_update = this->m_update;
 
                 return copy;
@@ -95,8 +106,14 @@ namespace ks
         class UniformArray final : public UniformBase
         {
         public:
-            UniformArray(std::string name, std::vector<T> data) :
-                UniformBase(name),
+            UniformArray(std::string const &name, std::vector<T> data) :
+                UniformArray(UniformHandle(name),std::move(data))
+            {
+
+            }
+
+            UniformArray(UniformHandle handle, std::vector<T> data) :
+                UniformBase(std::move(handle)),
                 m_size(data.size()),
                 m_data(data),
                 m_update(data),
@@ -107,14 +124,16 @@ namespace ks
 
             ~UniformArray() {}
 
+            // * Only the runs of elements that changed since the
+            //   last upload to @shader are sent to GL
             void GLSetUniform(gl::ShaderProgram* shader) const
             {
-                shader->GLSetUniform(m_name,m_data);
+                shader->GLSetUniform(m_handle,m_data);
             }
 
             UniformArray<T>* Copy() const
             {
-                UniformArray<T>* copy = new UniformArray<T>(m_name,m_data);
+                UniformArray<T>* copy = new UniformArray<T>(m_handle,m_data);
                 copy->m_update = this->m_update;
                 copy->m_reupload = this->m_reupload;
                 copy->m_list_update_idxs = this->m_list_update_idxs;
@@ -0,0 +1,97 @@
+/*
+   Copyright (C) 2015 Preet Desai (preet.desai@gmail.com)
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#include <ks/gl/KsGLUniformSet.hpp>
+
+namespace ks
+{
+    namespace gl
+    {
+        UniformSet::UniformSet()
+        {
+
+        }
+
+        UniformSet::~UniformSet()
+        {
+
+        }
+
+        uint UniformSet::GetSize() const
+        {
+            return m_list_entries.size();
+        }
+
+        UniformHandle const & UniformSet::GetHandle(uint index) const
+        {
+            return m_list_entries[index].handle;
+        }
+
+        void UniformSet::Sync()
+        {
+            bool updated = false;
+            for(u64 bits : m_list_back_dirty) {
+                if(bits) {
+                    updated = true;
+                    break;
+                }
+            }
+
+            if(!updated) {
+                return;
+            }
+
+            // The back buffer has the latest values for
+            // everything that was updated, and the front buffer
+            // has the latest values for everything else
+            std::swap(m_front,m_back);
+
+            // Bring the new back buffer up to date by copying
+            // over only the uniforms that were updated
+            for(uint w=0; w < m_list_back_dirty.size(); w++) {
+                u64 bits = m_list_back_dirty[w];
+                if(bits == 0) {
+                    continue;
+                }
+
+                m_list_back_dirty[w] = 0;
+
+                for(uint b=0; bits != 0; b++, bits >>= 1) {
+                    if(bits & 1) {
+                        Entry const &entry = m_list_entries[(w*64)+b];
+                        memcpy(&(m_back[entry.offset]),
+                               &(m_front[entry.offset]),
+                               entry.size_bytes);
+                    }
+                }
+            }
+        }
+
+        void UniformSet::GLSetUniforms(ShaderProgram* shader)
+        {
+            // Another set may have uploaded its values to
+            // @shader since this set was last used with it, so
+            // whether a value changed can only be decided by
+            // the shader
+            for(auto const &entry : m_list_entries) {
+                entry.upload(shader,
+                             entry.handle,
+                             &(m_front[entry.offset]),
+                             entry.count);
+            }
+        }
+    } // gl
+} // ks
@@ -0,0 +1,192 @@
+/*
+   Copyright (C) 2015 Preet Desai (preet.desai@gmail.com)
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#ifndef KS_GL_UNIFORM_SET_HPP
+#define KS_GL_UNIFORM_SET_HPP
+
+// stl
+#include <cstring>
+#include <type_traits>
+#include <vector>
+
+// ks
+#include <ks/gl/KsGLShaderProgram.hpp>
+
+namespace ks
+{
+    namespace gl
+    {
+        // UniformSet
+        // * Stores the values for a group of uniforms (ie. all
+        //   the uniforms for a material) contiguously
+        // * Values are double buffered: Update writes to the back
+        //   buffer, Sync swaps the buffers and GLSetUniforms reads
+        //   from the front buffer. Only uniforms that were updated
+        //   are copied during Sync
+        // * GLSetUniforms passes every value to the shader and relies
+        //   on ShaderProgram's copy of the last uploaded values to
+        //   skip unchanged ones, so sets that share a shader (ie.
+        //   two materials) can't see each other's values
+        // * Add and Update should be called from the update side,
+        //   GLSetUniforms from the rendering thread and Sync when
+        //   both sides are synchronized
+        class UniformSet final
+        {
+        public:
+            UniformSet();
+            ~UniformSet();
+
+            // * Adds a uniform with an initial value and returns
+            //   its index, which is used to update it
+            // * Adding a uniform isn't double buffered and must
+            //   not happen while GLSetUniforms could be called
+            template<typename T>
+            uint Add(UniformHandle handle,T const &value)
+            {
+                return add(std::move(handle),&value,1);
+            }
+
+            template<typename T>
+            uint Add(UniformHandle handle,std::vector<T> const &list_values)
+            {
+                static_assert(!std::is_same<T,bool>::value,
+                              "std::vector<bool> isn't contiguous");
+                assert(!list_values.empty());
+                return add(std::move(handle),
+                           list_values.data(),
+                           list_values.size());
+            }
+
+            template<typename T>
+            void Update(uint index,T const &value)
+            {
+                Update(index,0,&value,1);
+            }
+
+            template<typename T>
+            void Update(uint index,std::vector<T> const &list_values)
+            {
+                Update(index,0,list_values.data(),list_values.size());
+            }
+
+            // * Updates @count elements of a uniform array
+            //   starting at element @elem_index
+            template<typename T>
+            void Update(uint index,uint elem_index,T const * values,uint count)
+            {
+                Entry const &entry = m_list_entries[index];
+                assert(entry.upload == &UniformSet::upload<T>);
+                assert(elem_index+count <= entry.count);
+
+                memcpy(&(m_back[entry.offset+(elem_index*sizeof(T))]),
+                       values,
+                       count*sizeof(T));
+
+                setBit(m_list_back_dirty,index);
+            }
+
+            // * Returns the most recently updated value
+            template<typename T>
+            T const & Get(uint index,uint elem_index=0) const
+            {
+                Entry const &entry = m_list_entries[index];
+                assert(entry.upload == &UniformSet::upload<T>);
+                assert(elem_index < entry.count);
+
+                return *reinterpret_cast<T const*>(
+                            &(m_back[entry.offset+(elem_index*sizeof(T))]));
+            }
+
+            uint GetSize() const;
+            UniformHandle const & GetHandle(uint index) const;
+
+            // * Makes all updates since the last Sync
+            //   visible to GLSetUniforms
+            void Sync();
+
+            // * Sets all uniforms on @shader; only values that differ
+            //   from what @shader last uploaded reach GL
+            void GLSetUniforms(ShaderProgram* shader);
+
+        private:
+            using UploadFn =
+                void(*)(ShaderProgram*,UniformHandle const &,u8 const *,uint);
+
+            template<typename T>
+            static void upload(ShaderProgram* shader,
+                               UniformHandle const &handle,
+                               u8 const * data,
+                               uint count)
+            {
+                shader->GLSetUniform(handle,0,
+                                     reinterpret_cast<T const*>(data),
+                                     count);
+            }
+
+            template<typename T>
+            uint add(UniformHandle handle,T const * values,uint count)
+            {
+                // align the value in the buffers
+                uint offset = m_back.size();
+                offset += (alignof(T)-(offset%alignof(T)))%alignof(T);
+
+                uint const size_bytes = count*sizeof(T);
+                m_front.resize(offset+size_bytes);
+                m_back.resize(offset+size_bytes);
+
+                memcpy(&(m_front[offset]),values,size_bytes);
+                memcpy(&(m_back[offset]),values,size_bytes);
+
+                m_list_entries.push_back(
+                    Entry{std::move(handle),
+                          &UniformSet::upload<T>,
+                          offset,
+                          count,
+                          size_bytes});
+
+                uint const index = m_list_entries.size()-1;
+                m_list_back_dirty.resize((m_list_entries.size()+63)/64,0);
+
+                return index;
+            }
+
+            static void setBit(std::vector<u64> &list_bits,uint index)
+            {
+                list_bits[index/64] |= (u64(1) << (index%64));
+            }
+
+            struct Entry
+            {
+                UniformHandle handle;
+                UploadFn upload;
+                uint offset;
+                uint count;
+                uint size_bytes;
+            };
+
+            std::vector<Entry> m_list_entries;
+
+            // uniform values
+            std::vector<u8> m_front;
+            std::vector<u8> m_back;
+
+            // one bit per uniform
+            std::vector<u64> m_list_back_dirty; // updated, not synced
+        };
+    } // gl
+} // ks
+
+#endif // KS_GL_UNIFORM_SET_HPP
@@ -29,6 +29,7 @@
 #include <glm/gtc/type_ptr.hpp>
 
 // ks
+#include <ks/gl/KsGLAttributeBindings.hpp>
 #include <ks/gl/KsGLVertexBuffer.hpp>
 
 namespace ks
@@ -57,7 +58,9 @@ namespace ks
                                    Usage usage) :
             Buffer(Target::ArrayBuffer,usage),
             m_vertex_sz_bytes(calcVertexSize(list_attribs)),
-            m_list_attribs(list_attribs)
+            m_list_attribs(list_attribs),
+            m_bound_attr_locs_revision(0),
+            m_bound_attr_locs_valid(false)
         {
 
         }
@@ -74,19 +77,61 @@ namespace ks
                 return false;
             }
 
-            std::uintptr_t offset = offset_bytes;
+            return setAttribPointers(shader,offset_bytes,nullptr);
+        }
+
+        bool VertexBuffer::GLBindVxBuff(StateSet* state_set,
+                                        ShaderProgram* shader,
+                                        uint const offset_bytes)
+        {
+            if(!this->GLBind(state_set)) {
+                return false;
+            }
+
+            return setAttribPointers(shader,offset_bytes,state_set);
+        }
+
+        std::vector<GLuint> const * VertexBuffer::getAttribLocations(ShaderProgram* shader)
+        {
+            // Use the registered attribute bindings if they cover
+            // all of this buffer's attributes and @shader was linked
+            // with them; programs linked before the bindings last
+            // changed keep the locations they were linked with
+            u32 const revision = AttributeBindings::GetRevision();
+            if(revision != m_bound_attr_locs_revision) {
+                m_bound_attr_locs_revision = revision;
+                m_bound_attr_locs_valid = true;
+                m_list_bound_attr_locs.clear();
+
+                for(auto& attr : m_list_attribs) {
+                    GLuint attrib_loc;
+                    if(!AttributeBindings::Get(attr.m_name,attrib_loc)) {
+                        m_bound_attr_locs_valid = false;
+                        break;
+                    }
+                    m_list_bound_attr_locs.push_back(attrib_loc);
+                }
+            }
+
+            if(m_bound_attr_locs_valid &&
+               (shader->GetAttributeBindingsRevision() == revision)) {
+                return &m_list_bound_attr_locs;
+            }
 
             // Get the attribute location list for this shader
             auto attr_it = std::find_if(
                         m_list_shader_attr_locs.begin(),
                         m_list_shader_attr_locs.end(),
                         [shader](AttribLocsByShader const &attrs_by_shader) -> bool {
-                            return(attrs_by_shader.first == shader);
+                            return(attrs_by_shader.shader == shader);
                         });
 
-            // If we don't already have it cache all attribute
-            // locations for this shader for quick lookup
-            if(attr_it == m_list_shader_attr_locs.end())
+            // If we don't already have it (or the shader was reloaded)
+            // cache all attribute locations for this shader for
+            // quick lookup
+            u32 const generation = shader->GetGeneration();
+            if(attr_it == m_list_shader_attr_locs.end() ||
+               attr_it->generation != generation)
             {
                 std::vector<GLuint> list_attr_locs;
                 list_attr_locs.reserve(m_list_attribs.size());
@@ -96,22 +141,44 @@ namespace ks
                     if(attrib_loc < 0) {
                         LOG.Error() << "VertexBuffer::GLBindVxBuff: "
                                        "invalid attrib loc: " << attr.m_name;
-                        return false;
+                        return nullptr;
                     }
                     list_attr_locs.push_back(attrib_loc);
                 }
 
-                attr_it = m_list_shader_attr_locs.emplace(
-                            m_list_shader_attr_locs.end(),
-                            shader,
-                            list_attr_locs);
+                if(attr_it == m_list_shader_attr_locs.end()) {
+                    attr_it = m_list_shader_attr_locs.insert(
+                                m_list_shader_attr_locs.end(),
+                                AttribLocsByShader{shader,generation,
+                                                   std::move(list_attr_locs)});
+                }
+                else {
+                    attr_it->generation = generation;
+                    attr_it->list_attr_locs = std::move(list_attr_locs);
+                }
+            }
+
+            return &(attr_it->list_attr_locs);
+        }
+
+        bool VertexBuffer::setAttribPointers(ShaderProgram* shader,
+                                             uint const offset_bytes,
+                                             StateSet* state_set)
+        {
+            std::uintptr_t offset = offset_bytes;
+
+            std::vector<GLuint> const * list_attr_locs =
+                    getAttribLocations(shader);
+
+            if(!list_attr_locs) {
+                return false;
             }
 
             // Call glVertexAttribPointer to specify the layout
             // of the vertex attributes in the buffer data
             for(size_t i=0; i < m_list_attribs.size(); i++)
             {
-                GLint const attrib_location = attr_it->second[i];
+                GLint const attrib_location = (*list_attr_locs)[i];
 
                 // TODO
                 // Is it okay to specify vertex attribute locations
@@ -124,12 +191,23 @@ namespace ks
                 // attribute (GL_BYTE, GL_UNSIGNED_BYTE, GL_FLOAT, etc)
                 GLenum attrib_type = Attribute::list_type_glenums[type_idx];
 
-                glVertexAttribPointer(attrib_location,
-                                      m_list_attribs[i].m_component_count,
-                                      attrib_type,
-                                      m_list_attribs[i].m_normalized,
-                                      m_vertex_sz_bytes,
-                                      (const void*)offset);
+                if(state_set) {
+                    state_set->SetVertexAttribPointer(
+                                attrib_location,
+                                m_list_attribs[i].m_component_count,
+                                attrib_type,
+                                m_list_attribs[i].m_normalized,
+                                m_vertex_sz_bytes,
+                                offset);
+                }
+                else {
+                    glVertexAttribPointer(attrib_location,
+                                          m_list_attribs[i].m_component_count,
+                                          attrib_type,
+                                          m_list_attribs[i].m_normalized,
+                                          m_vertex_sz_bytes,
+                                          (const void*)offset);
+                }
 
                 // debug
                 // LOG.Info() << m_log_prefix
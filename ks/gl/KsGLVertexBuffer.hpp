@@ -120,7 +120,24 @@ namespace ks
             bool GLBindVxBuff(ShaderProgram* shader,
                               uint const offset_bytes=0);
 
+            // * Same as above but binds the buffer and sets the
+            //   attribute pointers through @state_set to skip
+            //   redundant glBindBuffer and glVertexAttribPointer calls
+            // * If every attribute in this buffer has a location in
+            //   AttributeBindings, those locations are used for all
+            //   shaders linked with the current bindings and the
+            //   pointers set up for one shader are reused by the next
+            bool GLBindVxBuff(StateSet* state_set,
+                              ShaderProgram* shader,
+                              uint const offset_bytes=0);
+
         private:
+            std::vector<GLuint> const * getAttribLocations(ShaderProgram* shader);
+
+            bool setAttribPointers(ShaderProgram* shader,
+                                   uint const offset_bytes,
+                                   StateSet* state_set);
+
             static u16 calcVertexSize(
                     std::vector<Attribute::Desc> const &list_attribs);
 
@@ -132,10 +149,23 @@ namespace ks
 
             // * Cache for quick lookup for shader vertex attribute locations
             //   corresponding to this buffer's vertex attribute indices
-            using AttribLocsByShader =
-                std::pair<ShaderProgram*,std::vector<GLuint>>;
+            // * Entries are rebuilt if the shader has been reloaded
+            //   since they were cached
+            struct AttribLocsByShader
+            {
+                ShaderProgram* shader;
+                u32 generation;
+                std::vector<GLuint> list_attr_locs;
+            };
 
             std::vector<AttribLocsByShader> m_list_shader_attr_locs;
+
+            // * Attribute locations from AttributeBindings, valid if
+            //   m_bound_attr_locs_revision matches its revision and
+            //   all of this buffer's attributes have a binding
+            u32 m_bound_attr_locs_revision;
+            bool m_bound_attr_locs_valid;
+            std::vector<GLuint> m_list_bound_attr_locs;
         };
 
         using VertexLayout = std::vector<VertexBuffer::Attribute::Desc>;
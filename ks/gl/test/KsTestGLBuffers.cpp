@@ -18,6 +18,7 @@
 #include <ks/gl/KsGLImplementation.hpp>
 #include <ks/gl/KsGLStateSet.hpp>
 #include <ks/gl/KsGLCommands.hpp>
+#include <ks/gl/KsGLShaderLibrary.hpp>
 
 #include <ks/gl/test/KsTestGLScene.hpp>
 
@@ -38,13 +39,7 @@ namespace {
 
     // Shader
     std::string const vertex_shader =
-                "#ifdef GL_ES\n"
-                "    //\n"
-                "#else\n"
-                "    #define lowp\n"
-                "    #define mediump\n"
-                "    #define highp\n"
-                "#endif\n"
+                "#include \"ks_precision.glsl\"\n"
                 "\n"
                 "attribute vec4 a_v4_position;\n"
                 "attribute vec4 a_v4_color;\n"
@@ -67,13 +62,7 @@ namespace {
                 "}\n";
 
     std::string const frag_shader =
-                "#ifdef GL_ES\n"
-                "    precision mediump float;\n"
-                "#else\n"
-                "    #define lowp\n"
-                "    #define mediump\n"
-                "    #define highp\n"
-                "#endif\n"
+                "#include \"ks_precision.glsl\"\n"
                 "\n"
                 "varying lowp vec4 v_v4_color;\n"
                 "\n"
@@ -309,12 +298,11 @@ namespace {
                 m_state_set->SetClearColor(0.15,0.15,0.15,1.0);
 
                 // Create shader
-                m_shader =
-                        make_unique<gl::ShaderProgram>(
-                            vertex_shader,
-                            frag_shader);
+                m_shader_library = make_unique<gl::ShaderLibrary>();
+                m_shader_library->AddSource("test.vsh",vertex_shader);
+                m_shader_library->AddSource("test.fsh",frag_shader);
 
-                m_shader->GLInit();
+                m_shader = m_shader_library->GLGetProgram("test.vsh","test.fsh");
 
                 // Create indices
                 unique_ptr<std::vector<u8>> list_ix =
@@ -346,9 +334,8 @@ namespace {
                             );
 
                 m_vx_buff_aos->GLInit();
-                m_vx_buff_aos->GLBind();
+                m_vx_buff_aos->GLBind(m_state_set.get());
                 m_vx_buff_aos->GLSync();
-                m_vx_buff_aos->GLUnbind();
 
                 // SOA vx buff
                 unique_ptr<std::vector<u8>> list_vx_soa0 =
@@ -384,9 +371,8 @@ namespace {
                                 list_vx_soa0.release()));
 
                 m_vx_buff_soa0->GLInit();
-                m_vx_buff_soa0->GLBind();
+                m_vx_buff_soa0->GLBind(m_state_set.get());
                 m_vx_buff_soa0->GLSync();
-                m_vx_buff_soa0->GLUnbind();
 
 
                 m_vx_buff_soa1 =
@@ -403,9 +389,8 @@ namespace {
                             );
 
                 m_vx_buff_soa1->GLInit();
-                m_vx_buff_soa1->GLBind();
+                m_vx_buff_soa1->GLBind(m_state_set.get());
                 m_vx_buff_soa1->GLSync();
-                m_vx_buff_soa1->GLUnbind();
 
 
                 m_vx_buff_soa2 =
@@ -422,9 +407,8 @@ namespace {
                             );
 
                 m_vx_buff_soa2->GLInit();
-                m_vx_buff_soa2->GLBind();
+                m_vx_buff_soa2->GLBind(m_state_set.get());
                 m_vx_buff_soa2->GLSync();
-                m_vx_buff_soa2->GLUnbind();
 
 
                 // create ix buff
@@ -441,9 +425,8 @@ namespace {
                             );
 
                 m_ix_buff->GLInit();
-                m_ix_buff->GLBind();
+                m_ix_buff->GLBind(m_state_set.get());
                 m_ix_buff->GLSync();
-                m_ix_buff->GLUnbind();
 
 
                 // done init
@@ -462,6 +445,7 @@ namespace {
 
                 bool const ok =
                         m_vx_buff_aos->GLBindVxBuff(
+                            m_state_set.get(),
                             m_shader.get(),
                             range.start_byte);
                 assert(ok);
@@ -479,9 +463,10 @@ namespace {
 
                 bool const ok =
                         m_vx_buff_aos->GLBindVxBuff(
+                            m_state_set.get(),
                             m_shader.get(),
                             vx_range.start_byte) &&
-                        m_ix_buff->GLBind();
+                        m_ix_buff->GLBind(m_state_set.get());
                 assert(ok);
 
                 gl::DrawElements(gl::Primitive::Triangles,
@@ -489,8 +474,6 @@ namespace {
                                  ix_range.size_bytes);
             }
 
-            m_vx_buff_aos->GLUnbind();
-
 
             // Non indexed SOA geometry
             for(uint i=0; i < 3; i++)
@@ -501,14 +484,17 @@ namespace {
 
                 bool const ok =
                         m_vx_buff_soa0->GLBindVxBuff(
+                            m_state_set.get(),
                             m_shader.get(),
                             range0.start_byte) &&
 
                         m_vx_buff_soa1->GLBindVxBuff(
+                            m_state_set.get(),
                             m_shader.get(),
                             range1.start_byte) &&
 
                         m_vx_buff_soa2->GLBindVxBuff(
+                            m_state_set.get(),
                             m_shader.get(),
                             range2.start_byte);
                 assert(ok);
@@ -529,14 +515,17 @@ namespace {
 
                 bool const ok =
                         m_vx_buff_soa0->GLBindVxBuff(
+                            m_state_set.get(),
                             m_shader.get(),
                             range0.start_byte) &&
 
                         m_vx_buff_soa1->GLBindVxBuff(
+                            m_state_set.get(),
                             m_shader.get(),
                             range1.start_byte) &&
 
                         m_vx_buff_soa2->GLBindVxBuff(
+                            m_state_set.get(),
                             m_shader.get(),
                             range2.start_byte);
                 assert(ok);
@@ -545,17 +534,13 @@ namespace {
                                  ix_range.start_byte,
                                  ix_range.size_bytes);
             }
-
-            m_vx_buff_soa0->GLUnbind();
-            m_vx_buff_soa1->GLUnbind();
-            m_vx_buff_soa2->GLUnbind();
-            m_ix_buff->GLUnbind();
         }
 
     private:
         bool m_init;
         unique_ptr<gl::StateSet> m_state_set;
-        unique_ptr<gl::ShaderProgram> m_shader;
+        unique_ptr<gl::ShaderLibrary> m_shader_library;
+        shared_ptr<gl::ShaderProgram> m_shader;
 
         shared_ptr<gl::IndexBuffer> m_ix_buff;
         std::vector<BufferRange> m_list_ix_ranges;
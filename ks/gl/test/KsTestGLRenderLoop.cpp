@@ -18,8 +18,10 @@
 #include <glm/glm.hpp>
 #include <ks/shared/KsCallbackTimer.hpp>
 #include <ks/gl/KsGLImplementation.hpp>
+#include <ks/gl/KsGLAttributeBindings.hpp>
 #include <ks/gl/KsGLStateSet.hpp>
 #include <ks/gl/KsGLCommands.hpp>
+#include <ks/gl/KsGLShaderLibrary.hpp>
 #include <ks/gl/test/KsTestGLScene.hpp>
 
 using namespace ks;
@@ -30,13 +32,7 @@ namespace {
 
     // Shader
     std::string const vertex_shader =
-                "#ifdef GL_ES\n"
-                "    //\n"
-                "#else\n"
-                "    #define lowp\n"
-                "    #define mediump\n"
-                "    #define highp\n"
-                "#endif\n"
+                "#include \"ks_precision.glsl\"\n"
                 "\n"
                 "attribute vec4 a_v4_position;\n"
                 "attribute vec4 a_v4_color;\n"
@@ -50,13 +46,7 @@ namespace {
                 "}\n";
 
     std::string const frag_shader =
-                "#ifdef GL_ES\n"
-                "    precision mediump float;\n"
-                "#else\n"
-                "    #define lowp\n"
-                "    #define mediump\n"
-                "    #define highp\n"
-                "#endif\n"
+                "#include \"ks_precision.glsl\"\n"
                 "\n"
                 "varying lowp vec4 v_v4_color;\n"
                 "\n"
@@ -108,13 +98,16 @@ namespace {
                 m_state_set->SetClearColor(0.15,0.15,0.15,1.0);
                 m_state_set->SetDepthTest(GL_FALSE);
 
+                // Use the same attribute locations for all shaders
+                gl::AttributeBindings::Set("a_v4_position",0);
+                gl::AttributeBindings::Set("a_v4_color",1);
+
                 // Create shader
-                m_shader =
-                        make_unique<gl::ShaderProgram>(
-                            vertex_shader,
-                            frag_shader);
+                m_shader_library = make_unique<gl::ShaderLibrary>();
+                m_shader_library->AddSource("test.vsh",vertex_shader);
+                m_shader_library->AddSource("test.fsh",frag_shader);
 
-                m_shader->GLInit();
+                m_shader = m_shader_library->GLGetProgram("test.vsh","test.fsh");
 
                 m_angle_rads = 0.0;
 
@@ -151,6 +144,12 @@ namespace {
                             glm::u8vec4(255,255,0,255)
                         });
 
+            // The previous buffer's handle may be reused, so it
+            // must be cleaned up through the StateSet
+            if(m_vx_buff) {
+                m_vx_buff->GLCleanUp(m_state_set.get());
+            }
+
             m_vx_buff =
                     make_unique<gl::VertexBuffer>(
                         vx_layout,
@@ -167,9 +166,8 @@ namespace {
                         ));
 
             m_vx_buff->GLInit();
-            m_vx_buff->GLBind();
+            m_vx_buff->GLBind(m_state_set.get());
             m_vx_buff->GLSync();
-            m_vx_buff->GLUnbind();
 
             m_range.start_byte = 0;
             m_range.size_bytes = list_vx_sz;
@@ -181,6 +179,7 @@ namespace {
             m_shader->GLEnable(m_state_set.get());
 
             gl::DrawArrays(gl::Primitive::Triangles,
+                           m_state_set.get(),
                            m_shader.get(),
                            m_vx_buff.get(),
                            m_range.start_byte,
@@ -190,7 +189,8 @@ namespace {
     private:
         bool m_init;
         unique_ptr<gl::StateSet> m_state_set;
-        unique_ptr<gl::ShaderProgram> m_shader;
+        unique_ptr<gl::ShaderLibrary> m_shader_library;
+        shared_ptr<gl::ShaderProgram> m_shader;
         unique_ptr<gl::VertexBuffer> m_vx_buff;
 
         float m_angle_rads;
@@ -19,6 +19,7 @@
 #include <ks/gl/KsGLImplementation.hpp>
 #include <ks/gl/KsGLStateSet.hpp>
 #include <ks/gl/KsGLCommands.hpp>
+#include <ks/gl/KsGLShaderLibrary.hpp>
 #include <ks/gl/KsGLTexture2D.hpp>
 #include <ks/gl/KsGLUniform.hpp>
 #include <ks/gl/test/KsTestGLScene.hpp>
@@ -31,13 +32,7 @@ namespace {
 
     // Shader
     std::string const vertex_shader =
-                "#ifdef GL_ES\n"
-                "    //\n"
-                "#else\n"
-                "    #define lowp\n"
-                "    #define mediump\n"
-                "    #define highp\n"
-                "#endif\n"
+                "#include \"ks_precision.glsl\"\n"
                 "\n"
                 "attribute vec4 a_v4_position;\n"
                 "attribute vec2 a_v2_tex0;\n"
@@ -51,13 +46,7 @@ namespace {
                 "}\n";
 
     std::string const frag_shader =
-                "#ifdef GL_ES\n"
-                "    precision mediump float;\n"
-                "#else\n"
-                "    #define lowp\n"
-                "    #define mediump\n"
-                "    #define highp\n"
-                "#endif\n"
+                "#include \"ks_precision.glsl\"\n"
                 "\n"
                 "varying lowp vec2 v_v2_tex0;\n"
                 "uniform lowp sampler2D u_s_tex0;\n"
@@ -111,12 +100,11 @@ namespace {
                 m_state_set->SetDepthTest(GL_FALSE);
 
                 // Create shader
-                m_shader =
-                        make_unique<gl::ShaderProgram>(
-                            vertex_shader,
-                            frag_shader);
+                m_shader_library = make_unique<gl::ShaderLibrary>();
+                m_shader_library->AddSource("test.vsh",vertex_shader);
+                m_shader_library->AddSource("test.fsh",frag_shader);
 
-                m_shader->GLInit();
+                m_shader = m_shader_library->GLGetProgram("test.vsh","test.fsh");
 
                 // Create vertex buffer
                 unique_ptr<std::vector<u8>> list_vx =
@@ -179,9 +167,8 @@ namespace {
                                 list_vx.release()));
 
                 m_vx_buff->GLInit();
-                m_vx_buff->GLBind();
+                m_vx_buff->GLBind(m_state_set.get());
                 m_vx_buff->GLSync();
-                m_vx_buff->GLUnbind();
 
                 m_range.start_byte = 0;
                 m_range.size_bytes = list_vx_sz;
@@ -219,7 +206,7 @@ namespace {
                             gl::Texture2D::Format::RGBA8);
 
                 m_texture->SetFilterModes(
-                            gl::Texture2D::Filter::Nearest,
+                            gl::Texture2D::Filter::NearestMipmapNearest,
                             gl::Texture2D::Filter::Nearest);
 
                 m_texture->SetWrapModes(
@@ -231,14 +218,21 @@ namespace {
 
                 m_texture->UpdateTexture(
                             gl::Texture2D::Update{
-                                gl::Texture2D::Update::ReUpload,
+                                gl::Texture2D::Update::ReUpload |
+                                gl::Texture2D::Update::GenerateMipmaps,
                                 glm::u16vec2(0,0),
                                 sptr_image_data
                             });
 
                 m_texture->GLInit();
                 m_texture->GLBind(m_state_set.get(),0);
-                m_texture->GLSync();
+                m_texture->GLSync(m_state_set.get());
+
+                // Create the sampler uniform once; creating its
+                // handle interns the name
+                m_u_sampler =
+                        make_unique<gl::Uniform<gl::Sampler>>(
+                            "u_s_tex0",gl::Sampler{0});
 
                 // done init
                 m_init = true;
@@ -250,12 +244,15 @@ namespace {
             // Draw!
             m_shader->GLEnable(m_state_set.get());
 
-            m_texture->GLBind(m_state_set.get(),0);
+            GLint const tex_unit =
+                    m_texture->GLAllocUnitAndBind(m_state_set.get());
 
-            gl::Uniform<GLint> u_sampler("u_s_tex0",0);
-            u_sampler.GLSetUniform(m_shader.get());
+            m_u_sampler->Update(gl::Sampler{tex_unit});
+            m_u_sampler->Sync();
+            m_u_sampler->GLSetUniform(m_shader.get());
 
             gl::DrawArrays(gl::Primitive::Triangles,
+                           m_state_set.get(),
                            m_shader.get(),
                            m_vx_buff.get(),
                            m_range.start_byte,
@@ -265,9 +262,11 @@ namespace {
     private:
         bool m_init;
         unique_ptr<gl::StateSet> m_state_set;
-        unique_ptr<gl::ShaderProgram> m_shader;
+        unique_ptr<gl::ShaderLibrary> m_shader_library;
+        shared_ptr<gl::ShaderProgram> m_shader;
         unique_ptr<gl::VertexBuffer> m_vx_buff;
         unique_ptr<gl::Texture2D> m_texture;
+        unique_ptr<gl::Uniform<gl::Sampler>> m_u_sampler;
 
         BufferRange m_range;
     };
@@ -10,34 +10,76 @@ CONFIG(debug,debug|release) {
     message("ks: OpenGL Debugging enabled")
 }
 
+# gl call statistics (CONFIG += ks_gl_stats)
+ks_gl_stats {
+    DEFINES += KS_GL_STATS
+    message("ks: OpenGL call statistics enabled")
+}
+
+# shader hot reload (CONFIG += ks_gl_shader_hot_reload)
+ks_gl_shader_hot_reload {
+    DEFINES += KS_GL_SHADER_HOT_RELOAD
+    HEADERS += $${PATH_KS_GL}/KsGLShaderHotReload.hpp
+    SOURCES += $${PATH_KS_GL}/KsGLShaderHotReload.cpp
+    message("ks: OpenGL shader hot reload enabled")
+}
+
 HEADERS += \
     $${PATH_KS_GL}/KsGLInclude.hpp \
     $${PATH_KS_GL}/KsGLConfig.hpp \
     $${PATH_KS_GL}/KsGLDebug.hpp \
+    $${PATH_KS_GL}/KsGLStats.hpp \
     $${PATH_KS_GL}/KsGLImplementation.hpp \
     $${PATH_KS_GL}/KsGLResource.hpp \
     $${PATH_KS_GL}/KsGLStateSet.hpp \
+    $${PATH_KS_GL}/KsGLAttributeBindings.hpp \
     $${PATH_KS_GL}/KsGLShaderProgram.hpp \
+    $${PATH_KS_GL}/KsGLProgramBinaryCache.hpp \
+    $${PATH_KS_GL}/KsGLShaderLibrary.hpp \
     $${PATH_KS_GL}/KsGLUniform.hpp \
+    $${PATH_KS_GL}/KsGLUniformSet.hpp \
     $${PATH_KS_GL}/KsGLTexture.hpp \
     $${PATH_KS_GL}/KsGLBuffer.hpp \
     $${PATH_KS_GL}/KsGLIndexBuffer.hpp \
     $${PATH_KS_GL}/KsGLVertexBuffer.hpp \
     $${PATH_KS_GL}/KsGLTexture2D.hpp \
+    $${PATH_KS_GL}/KsGLImageUtils.hpp \
+    $${PATH_KS_GL}/KsGLKTXLoader.hpp \
+    $${PATH_KS_GL}/KsGLTextureAtlas.hpp \
+    $${PATH_KS_GL}/KsGLTextureStreamer.hpp \
+    $${PATH_KS_GL}/KsGLTextureResidency.hpp \
+    $${PATH_KS_GL}/KsGLRenderBuffer.hpp \
+    $${PATH_KS_GL}/KsGLFrameBuffer.hpp \
+    $${PATH_KS_GL}/KsGLRenderTargetPool.hpp \
+    $${PATH_KS_GL}/KsGLRenderGraph.hpp \
     $${PATH_KS_GL}/KsGLCommands.hpp \
     $${PATH_KS_GL}/KsGLCamera.hpp
 
 SOURCES += \
     $${PATH_KS_GL}/KsGLDebug.cpp \
+    $${PATH_KS_GL}/KsGLStats.cpp \
     $${PATH_KS_GL}/KsGLResource.cpp \
     $${PATH_KS_GL}/KsGLImplementation.cpp \
     $${PATH_KS_GL}/KsGLStateSet.cpp \
+    $${PATH_KS_GL}/KsGLAttributeBindings.cpp \
     $${PATH_KS_GL}/KsGLShaderProgram.cpp \
+    $${PATH_KS_GL}/KsGLProgramBinaryCache.cpp \
+    $${PATH_KS_GL}/KsGLShaderLibrary.cpp \
+    $${PATH_KS_GL}/KsGLUniformSet.cpp \
     $${PATH_KS_GL}/KsGLTexture.cpp \
     $${PATH_KS_GL}/KsGLBuffer.cpp \
     $${PATH_KS_GL}/KsGLIndexBuffer.cpp \
     $${PATH_KS_GL}/KsGLVertexBuffer.cpp \
-    $${PATH_KS_GL}/KsGLTexture2D.cpp
+    $${PATH_KS_GL}/KsGLTexture2D.cpp \
+    $${PATH_KS_GL}/KsGLImageUtils.cpp \
+    $${PATH_KS_GL}/KsGLKTXLoader.cpp \
+    $${PATH_KS_GL}/KsGLTextureAtlas.cpp \
+    $${PATH_KS_GL}/KsGLTextureStreamer.cpp \
+    $${PATH_KS_GL}/KsGLTextureResidency.cpp \
+    $${PATH_KS_GL}/KsGLRenderBuffer.cpp \
+    $${PATH_KS_GL}/KsGLFrameBuffer.cpp \
+    $${PATH_KS_GL}/KsGLRenderTargetPool.cpp \
+    $${PATH_KS_GL}/KsGLRenderGraph.cpp
 
 # opengl function loading lib if required
 linux {